@@ -412,6 +412,8 @@ const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemo
     static LTDataRef DRquick("livetraffic/bulk/quick");
     static LTDataRef DRexpsv("livetraffic/bulk/expensive");
 
+    lastStats = UpdateStats();
+
     // a few sanity checks...without LT displaying aircrafts
     // and access to ac/key there is nothing to do.
     // (Calling doesLTDisplayAc before calling any other dataRef
@@ -429,6 +431,7 @@ const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemo
     }
     
     // *** There are numAc aircrafts to be reported ***
+    lastStats.numAc = lastStats.numKept = numAc;
     
     // To figure out which aircraft has gone we keep an update flag
     // with the aircraft. Let's reset that flag first.
@@ -450,9 +453,123 @@ const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemo
         DoBulkFetch<LTAPIAircraft::LTAPIBulkInfoTexts>(numAc, DRexpsv, sizeLTStruct,
                                                        vInfoTexts);
         lastExpsvFetch = std::chrono::steady_clock::now();
+        lastStats.numInfo = numAc;
     }
         
     // ***  Now handle aircrafts in our map, which did _not_ get updated ***
+    RemoveOutdatedAc(plistRemovedAc);
+    
+    // We're done, return the result
+    return mapAc;
+}
+
+// Like UpdateAcList(), but only keeps aircraft accepted by a filter
+const MapLTAPIAircraft& LTAPIConnect::UpdateAcListFiltered (fFilterAc* pfFilter, void* pFilterRef,
+                                                            ListLTAPIAircraft* plistRemovedAc)
+{
+    static LTDataRef DRquick("livetraffic/bulk/quick");
+    static LTDataRef DRexpsv("livetraffic/bulk/expensive");
+    
+    typedef LTAPIAircraft::LTAPIBulkData BulkT;
+    typedef LTAPIAircraft::LTAPIBulkInfoTexts InfoT;
+    
+    assert(pfFilter);
+    lastStats = UpdateStats();
+    
+    // same sanity checks as in UpdateAcList()
+    const int numAc = isLTAvail() && doesLTDisplayAc() && DRquick.isValid() && DRexpsv.isValid() ? getLTNumAc() : 0;
+    for (MapLTAPIAircraft::value_type& p: mapAc)
+        p.second->resetUpdated();
+    
+    if (numAc <= 0) {
+        RemoveOutdatedAc(plistRemovedAc);
+        return mapAc;
+    }
+    lastStats.numAc = numAc;
+    
+    // *** Numeric data: filter while receiving ***
+    // Only aircraft passing the filter get an object, all others are
+    // skipped right away in the receive buffer.
+    bool bNewAc = false;
+    vKeptIdx.clear();                       // keeps capacity from previous calls
+    const int sizeLTNum = DRquick.getData(NULL, 0, sizeof(BulkT));
+    for (int ac = 0; ac < numAc; ac += iBulkAc)
+    {
+        const int bytes = DRquick.getData(vBulkNum.get(), ac * sizeof(BulkT), iBulkAc * sizeof(BulkT));
+        if (bytes <= 0)
+            break;
+        lastStats.bytesRcvd += size_t(bytes);
+        const int acRcvd = std::min(bytes / int(sizeof(BulkT)), iBulkAc);
+        
+        for (int i = 0; i < acRcvd; i++)
+        {
+            BulkT& bulk = vBulkNum[i];
+            // the filter wants to see proper position values also from older LT versions
+            if (size_t(sizeLTNum) < LTAPIBulkData_v122) {
+                bulk.lat = bulk.lat_f;
+                bulk.lon = bulk.lon_f;
+                bulk.alt_ft = bulk.alt_ft_f;
+            }
+            
+            if (!pfFilter(bulk, pFilterRef))
+                continue;
+            
+            const std::string key = LTAPI::hexStr(bulk.keyNum);
+            MapLTAPIAircraft::iterator iter = mapAc.find(key);
+            if (iter == mapAc.end())
+            {
+                assert(pfCreateAcObject);
+                iter = mapAc.emplace(key, pfCreateAcObject()).first;
+                bNewAc = true;
+            }
+            iter->second->updateAircraft(bulk, sizeLTNum);
+            vKeptIdx.push_back(ac + i);
+        }
+    }
+    lastStats.numKept = int(vKeptIdx.size());
+    
+    // *** Info texts: only for the kept aircraft ***
+    // Fetched as contiguous runs of LT indexes, so a handful of kept aircraft
+    // among hundreds costs a handful of small transfers only.
+    if (!vKeptIdx.empty() &&
+        (bNewAc || std::chrono::steady_clock::now() - lastExpsvFetch > sPeriodExpsv))
+    {
+        const int sizeLTInfo = DRexpsv.getData(NULL, 0, sizeof(InfoT));
+        const size_t nKept = vKeptIdx.size();
+        for (size_t s = 0; s < nKept; )
+        {
+            size_t e = s + 1;
+            while (e < nKept && vKeptIdx[e] == vKeptIdx[e-1] + 1 && int(e - s) < iBulkAc)
+                e++;
+            
+            const int bytes = DRexpsv.getData(vInfoTexts.get(), vKeptIdx[s] * sizeof(InfoT),
+                                              int(e - s) * sizeof(InfoT));
+            s = e;
+            if (bytes <= 0)
+                continue;
+            lastStats.bytesRcvd += size_t(bytes);
+            const int acRcvd = std::min(bytes / int(sizeof(InfoT)), iBulkAc);
+            
+            for (int i = 0; i < acRcvd; i++)
+            {
+                const InfoT& info = vInfoTexts[i];
+                // LT's list might have shifted meanwhile, so verify by key
+                MapLTAPIAircraft::iterator iter = mapAc.find(LTAPI::hexStr(info.keyNum));
+                if (iter != mapAc.end() && iter->second->isUpdated() &&
+                    iter->second->updateAircraft(info, sizeLTInfo))
+                    lastStats.numInfo++;
+            }
+        }
+        lastExpsvFetch = std::chrono::steady_clock::now();
+    }
+    
+    RemoveOutdatedAc(plistRemovedAc);
+    return mapAc;
+}
+
+// Removes aircraft objects that did not get updated
+void LTAPIConnect::RemoveOutdatedAc (ListLTAPIAircraft* plistRemovedAc)
+{
     for (MapLTAPIAircraft::iterator iter = mapAc.begin();
          iter != mapAc.end();
          /* no loop increment*/)
@@ -470,9 +587,6 @@ const MapLTAPIAircraft& LTAPIConnect::UpdateAcList (ListLTAPIAircraft* plistRemo
             // go to next element (without removing this one)
             iter++;
     }
-    
-    // We're done, return the result
-    return mapAc;
 }
 
 // Finds an aircraft for a given multiplayer slot
@@ -539,9 +653,12 @@ bool LTAPIConnect::DoBulkFetch (int numAc, LTDataRef& DR, int& outSizeLT,
     {
         // get a bulk of data from LiveTraffic
         // (std::min(...iBulkAc) makes sure we don't exceed our array)
-        const int acRcvd = std::min (DR.getData(vBulk.get(),
-                                                ac * sizeof(T),
-                                                iBulkAc * sizeof(T)) / int(sizeof(T)),
+        const int bytes = DR.getData(vBulk.get(),
+                                     ac * sizeof(T),
+                                     iBulkAc * sizeof(T));
+        if (bytes > 0)
+            lastStats.bytesRcvd += size_t(bytes);
+        const int acRcvd = std::min (bytes / int(sizeof(T)),
                                      iBulkAc);
         
         // inner loop: copy the received data into the aircraft objects
@@ -35,6 +35,7 @@
 #include <string>
 #include <list>
 #include <map>
+#include <vector>
 #include <chrono>
 
 #include "XPLMDataAccess.h"
@@ -330,6 +331,23 @@ public:
     /// a new aircraft object.
     typedef LTAPIAircraft* fCreateAcObject();
     
+    /// @brief Filter callback type passed in to UpdateAcListFiltered()
+    /// @param bulk Numeric data of one aircraft as just received from LiveTraffic
+    /// @param ref Opaque pointer handed through from UpdateAcListFiltered()
+    /// @return `true` if the aircraft shall be kept, `false` if it shall be skipped
+    ///
+    /// The callback is called _before_ an aircraft object is created,
+    /// so rejected aircraft cost neither an object nor a fetch of info texts.
+    typedef bool fFilterAc(const LTAPIAircraft::LTAPIBulkData& bulk, void* ref);
+
+    /// @brief Statistics of the last call to UpdateAcList() or UpdateAcListFiltered()
+    struct UpdateStats {
+        int         numAc       = 0;    ///< number of aircraft reported by LiveTraffic
+        int         numKept     = 0;    ///< number of aircraft that passed the filter
+        int         numInfo     = 0;    ///< number of aircraft for which info texts were fetched
+        size_t      bytesRcvd   = 0;    ///< number of bytes received from LiveTraffic
+    };
+
     /// Number of seconds between two calls of the expensive type,
     /// which fetches all texts from LiveTraffic, which in fact don't change
     /// that often anyway
@@ -342,6 +360,10 @@ protected:
     std::unique_ptr<LTAPIAircraft::LTAPIBulkData[]> vBulkNum;
     /// bulk info text array for communication with LT
     std::unique_ptr<LTAPIAircraft::LTAPIBulkInfoTexts[]> vInfoTexts;
+    /// LT indexes of aircraft kept by UpdateAcListFiltered(), reused between calls
+    std::vector<int> vKeptIdx;
+    /// statistics of the last update
+    UpdateStats lastStats;
 
 protected:
     /// Pointer to callback function returning new aircraft objects
@@ -418,6 +440,21 @@ public:
     ///        LTAPI will only _emplace_back_ to the list, never remove anything.
     const MapLTAPIAircraft& UpdateAcList (ListLTAPIAircraft* plistRemovedAc = nullptr);
     
+    /// @brief Like UpdateAcList(), but only keeps aircraft accepted by a filter
+    /// @param pfFilter Filter callback, called with the numeric bulk data of each aircraft
+    /// @param pFilterRef Opaque pointer handed through to `pfFilter`
+    /// @param plistRemovedAc (Optional) see UpdateAcList()
+    ///
+    /// Aircraft rejected by the filter don't get an object (or lose it if they
+    /// had one) and their info texts are never fetched. Info texts are only
+    /// requested for the index ranges of kept aircraft.
+    /// Use this if you are interested in a small subset of LiveTraffic's aircraft only.
+    const MapLTAPIAircraft& UpdateAcListFiltered (fFilterAc* pfFilter, void* pFilterRef,
+                                                  ListLTAPIAircraft* plistRemovedAc = nullptr);
+
+    /// Statistics of the last call to UpdateAcList() or UpdateAcListFiltered()
+    const UpdateStats& getUpdateStats () const { return lastStats; }
+
     /// Returns the map of aircraft as it currently stands
     const MapLTAPIAircraft& getAcMap () const { return mapAc; }
     
@@ -444,6 +481,10 @@ protected:
     template <class T>
     bool DoBulkFetch (int numAc, LTDataRef& DR, int& outSizeLT,
                       std::unique_ptr<T[]> &vBulk);
+
+    /// @brief Removes aircraft objects that did not get updated
+    /// @param plistRemovedAc (Optional) see UpdateAcList()
+    void RemoveOutdatedAc (ListLTAPIAircraft* plistRemovedAc);
     
     /// @brief shared DataRef event notification
     static void CameraSharedDataCB (LTAPIConnect* me);
@@ -0,0 +1,394 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Accessor throughput benchmark on synthetic worlds.
+//
+//   os_accbench [-v] [-k] [-t] [-f frames] [-p pkg_dir] [-r draw_radius_km] [-x spacing]
+//               [-n sceneries] [-m jetways] [-s stands] [-a anims] [-d dgs]
+//
+// -n, -m, -s, -a, -d take comma separated lists, all combinations are run.
+// Each world runs in a forked process so the plugin starts from scratch.
+// Per frame all objects of the sceneries within the draw radius are "drawn"
+// family by family like X-Plane does with instanced objects:
+// jetways, DGS, SAM1 VDGS, animated objects, autoplay objects.
+// The plane waits 50 m in front of the first stand with the beacon on.
+// With -t it taxies in, shuts down and docks while the DGS guides it,
+// the jetways are put in docking position for that.
+//
+// Results go as JSON to stdout.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "XPLMDataAccess.h"
+#include "XPLMGraphics.h"
+
+#include "openSAM.h"
+#include "plane.h"
+
+#include "xplm_standin.h"
+#include "synth_world.h"
+
+static constexpr float kFrameDt = 1.0f / 30.0f;
+static constexpr float kApproachDist = 50.0f;   // m
+static constexpr float kTaxiSpeed = 3.0f;       // m/s
+static constexpr float kNoseGearZ = -12.6f;     // m, the stop position is the nose wheel
+
+static const char *jw_drefs[] = {
+    "rotate1", "rotate2", "rotate3", "extent", "wheels",
+    "wheelrotatec", "wheelrotater", "wheelrotatel", "warnlight"
+};
+
+static const char *dgs_drefs[] = {
+    "opensam/dgs/ident", "opensam/dgs/status", "opensam/dgs/lr", "opensam/dgs/track",
+    "opensam/dgs/azimuth", "opensam/dgs/distance", "opensam/dgs/icao_0", "opensam/dgs/icao_1",
+    "opensam/dgs/icao_2", "opensam/dgs/icao_3", "opensam/dgs/vdgs_brightness"
+};
+
+static const char *sam1_drefs[] = {
+    "sam/vdgs/status", "sam/docking/lateral", "sam/docking/longitudinal"
+};
+
+enum Family { kFamJw, kFamDgs, kFamSam1, kFamAnim, kFamAuto, kFamNum };
+
+static const char *family_name[kFamNum] = {
+    "jw_anim_acc", "read_dgs_acc", "read_sam1_acc", "anim_acc", "auto_drf_acc"
+};
+
+struct Result {
+    unsigned long long calls;
+    double ns;
+};
+
+// an object in local coordinates with the datarefs it reads
+struct DrawObj {
+    float x, y, z, psi;
+    std::vector<XPLMDataRef> drefs;
+};
+
+struct Options {
+    int frames{300};
+    bool keep{false};
+    bool verbose{false};
+    bool taxi_in{false};
+    double draw_radius{15.0};   // km
+    std::string pkg_dir{"openSAM-pkg/openSAM"};
+};
+
+static XPLMDataRef obj_x_dr, obj_y_dr, obj_z_dr, obj_psi_dr;
+
+static DrawObj
+draw_obj(const SynthObj& o, const std::vector<XPLMDataRef>& drefs)
+{
+    // the plugin sees sam.xml values with float precision
+    double x, y, z;
+    XPLMWorldToLocal((float)o.lat, (float)o.lon, o.elevation, &x, &y, &z);
+    return DrawObj{(float)x, (float)y, (float)z, o.psi, drefs};
+}
+
+static XPLMDataRef
+find_dref(const std::string& name)
+{
+    XPLMDataRef dr = XPLMFindDataRef(name.c_str());
+    if (dr == nullptr) {
+        fprintf(stderr, "dataref '%s' not found\n", name.c_str());
+        exit(1);
+    }
+    return dr;
+}
+
+// draw all objects of a family, return the sum of values read
+static double
+draw(const std::vector<DrawObj>& objs, Result& res)
+{
+    double sum = 0.0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto& o : objs) {
+        XPLMSetDataf(obj_x_dr, o.x);
+        XPLMSetDataf(obj_y_dr, o.y);
+        XPLMSetDataf(obj_z_dr, o.z);
+        XPLMSetDataf(obj_psi_dr, o.psi);
+        for (auto dr : o.drefs)
+            sum += XPLMGetDataf(dr);
+        res.calls += o.drefs.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    res.ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    return sum;
+}
+
+// taxi into the stand, shut down when there
+static void
+taxi_in(const SynthObj& stand, float t)
+{
+    float d = std::max(kApproachDist - kTaxiSpeed * t, 0.0f);
+    xps_place_plane(stand.lat - (d - kNoseGearZ) / 111120.0, stand.lon, stand.psi);
+    if (d > 0.0f)
+        return;
+
+    xps_set("sim/flightmodel/controls/parkbrake", 1.0);
+    xps_set("sim/cockpit2/switches/beacon_on", 0);
+    xps_set_vi("sim/flightmodel/engine/ENGN_running", {0, 0});
+}
+
+static int
+run_world(const Options& opt, const SynthWorldCfg& cfg)
+{
+    SynthWorld world = synth_world_generate(cfg);
+    std::string dir = synth_mkdtemp("os_accbench");
+    if (dir.empty() || !synth_world_write(world, dir, opt.pkg_dir)) {
+        fprintf(stderr, "can't write synthetic world\n");
+        return 1;
+    }
+
+    const SynthScenery& home = world.sceneries[0];
+    const SynthObj& stand = home.stands[0];
+
+    xps_quiet(!opt.verbose);
+    xps_set_xp_dir(dir);
+    xps_set_aircraft(dir + "Aircraft/A320/A320.acf");
+    for (auto& sc : world.sceneries)
+        xps_add_airport(sc.name.c_str(), sc.lat, sc.lon, 0.0f);
+
+    // plane on ground 50 m in front of the first stand, ready for docking
+    xps_set_ref(home.lat, home.lon);
+    xps_place_plane(stand.lat - 50.0 / 111120.0, stand.lon, stand.psi);
+    xps_set("sim/flightmodel/forces/fnrml_gear", 50000.0);
+    xps_set("sim/cockpit2/switches/beacon_on", 1);
+    xps_set_vi("sim/flightmodel/engine/ENGN_running", {1, 1});
+    xps_set_str("sim/aircraft/view/acf_ICAO", "A320");
+    xps_set_vf("sim/aircraft/parts/acf_gear_znodef", {kNoseGearZ, 1.5f});
+
+    if (!xps_plugin_start()) {
+        fprintf(stderr, "XPluginStart failed\n");
+        return 1;
+    }
+
+    xps_message(XPLM_MSG_PLANE_LOADED);
+    xps_message(XPLM_MSG_AIRPORT_LOADED);
+    for (int i = 0; i < 60; i++)
+        xps_run_frame(kFrameDt);
+    xps_command("openSAM/activate");
+    for (int i = 0; i < 150; i++)
+        xps_run_frame(kFrameDt);
+
+    obj_x_dr = find_dref("sim/graphics/animation/draw_object_x");
+    obj_y_dr = find_dref("sim/graphics/animation/draw_object_y");
+    obj_z_dr = find_dref("sim/graphics/animation/draw_object_z");
+    obj_psi_dr = find_dref("sim/graphics/animation/draw_object_psi");
+
+    std::vector<XPLMDataRef> jw_dr, dgs_dr, sam1_dr, auto_dr;
+    std::vector<std::vector<XPLMDataRef>> anim_dr;
+
+    for (auto n : jw_drefs)
+        jw_dr.push_back(find_dref(std::string("sam/jetway/") + n));
+    for (auto n : dgs_drefs)
+        dgs_dr.push_back(find_dref(n));
+    for (auto n : sam1_drefs)
+        sam1_dr.push_back(find_dref(n));
+    for (auto& n : world.anim_drefs)
+        anim_dr.push_back({find_dref(n)});
+    for (auto& n : world.auto_drefs)
+        auto_dr.push_back(find_dref(n));
+
+    // objects in sight
+    std::vector<DrawObj> objs[kFamNum];
+    double cos_lat = cos(home.lat * M_PI / 180.0);
+    int n_drawn = 0;
+    for (auto& sc : world.sceneries) {
+        double dlat = (sc.lat - home.lat) * 111.12;
+        double dlon = (sc.lon - home.lon) * 111.12 * cos_lat;
+        if (sqrt(dlat * dlat + dlon * dlon) > opt.draw_radius)
+            continue;
+
+        n_drawn++;
+        for (auto& o : sc.jetways)
+            objs[kFamJw].push_back(draw_obj(o, jw_dr));
+        for (auto& o : sc.dgs) {
+            objs[kFamDgs].push_back(draw_obj(o, dgs_dr));
+            objs[kFamSam1].push_back(draw_obj(o, sam1_dr));
+        }
+        for (unsigned k = 0; k < sc.anims.size(); k++) {
+            objs[kFamAnim].push_back(draw_obj(sc.anims[k], anim_dr[k]));
+            if (! auto_dr.empty())
+                objs[kFamAuto].push_back(draw_obj(sc.anims[k], {auto_dr[k % auto_dr.size()]}));
+        }
+    }
+
+    if (opt.taxi_in)
+        my_plane.auto_mode_set(true);   // jetways are selected without the UI
+
+    Result res[kFamNum]{};
+    Result frame{}, loop{};
+    double checksum = 0.0;
+    for (int i = 0; i < opt.frames; i++) {
+        if (opt.taxi_in) {
+            taxi_in(stand, i * kFrameDt);
+            if (my_plane.state() == Plane::CAN_DOCK)
+                xps_command("openSAM/dock_jwy");
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        xps_run_frame(kFrameDt);
+        auto t1 = std::chrono::steady_clock::now();
+        loop.ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+        for (int f = 0; f < kFamNum; f++)
+            checksum += draw(objs[f], res[f]);
+        auto t2 = std::chrono::steady_clock::now();
+        frame.ns += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    }
+
+    const char *plane_state = Plane::state_str_[my_plane.state()];
+
+    xps_plugin_stop();
+
+    if (!opt.keep)
+        std::filesystem::remove_all(dir);
+
+    printf("  {\"world\": {\"sceneries\": %d, \"jetways\": %d, \"stands\": %d, \"anims\": %d, "
+           "\"dgs\": %d, \"spacing\": %g, \"sceneries_drawn\": %d},\n",
+           cfg.n_sceneries, cfg.n_jetways, world.cfg.n_stands, cfg.n_anims, cfg.n_dgs,
+           cfg.spacing, n_drawn);
+    printf("   \"frames\": %d, \"frame_ns\": %0.0f, \"loop_ns\": %0.0f, \"checksum\": %0.6g, "
+           "\"plane_state\": \"%s\",\n   \"accessors\": {",
+           opt.frames, opt.frames ? frame.ns / opt.frames : 0.0, opt.frames ? loop.ns / opt.frames : 0.0,
+           checksum, plane_state);
+    for (int f = 0; f < kFamNum; f++) {
+        const Result& r = res[f];
+        printf("%s\n    \"%s\": {\"calls\": %llu, \"ns_per_call\": %0.1f, \"calls_per_s\": %0.0f}",
+               f ? "," : "", family_name[f], r.calls,
+               r.calls ? r.ns / r.calls : 0.0, r.ns > 0.0 ? r.calls / (r.ns * 1.0E-9) : 0.0);
+    }
+    printf("}}");
+    fflush(stdout);
+    return 0;
+}
+
+static std::vector<int>
+int_list(const char *arg)
+{
+    std::vector<int> l;
+    for (const char *s = arg; *s; ) {
+        l.push_back(atoi(s));
+        s = strchr(s, ',');
+        if (s == nullptr)
+            break;
+        s++;
+    }
+    return l;
+}
+
+static void
+usage()
+{
+    fprintf(stderr, "usage: os_accbench [-v] [-k] [-t] [-f frames] [-p pkg_dir] [-r draw_radius_km] [-x spacing]\n"
+                    "                   [-n sceneries] [-m jetways] [-s stands] [-a anims] [-d dgs]\n");
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    Options opt;
+    SynthWorldCfg base;
+    std::vector<int> n_sc{1, 10, 100}, n_jw{20}, n_st{40}, n_an{10}, n_dgs{20};
+
+    int c;
+    while ((c = getopt(argc, argv, "vktf:p:r:x:n:m:s:a:d:")) != -1) {
+        switch (c) {
+            case 'v': opt.verbose = true; break;
+            case 'k': opt.keep = true; break;
+            case 't': opt.taxi_in = base.dock_jws = true; break;
+            case 'f': opt.frames = atoi(optarg); break;
+            case 'p': opt.pkg_dir = optarg; break;
+            case 'r': opt.draw_radius = atof(optarg); break;
+            case 'x': base.spacing = atof(optarg); break;
+            case 'n': n_sc = int_list(optarg); break;
+            case 'm': n_jw = int_list(optarg); break;
+            case 's': n_st = int_list(optarg); break;
+            case 'a': n_an = int_list(optarg); break;
+            case 'd': n_dgs = int_list(optarg); break;
+            default: usage();
+        }
+    }
+
+    printf("{\"benchmark\": \"accessors\", \"version\": \"%s\", \"compiler\": \"%s\",\n"
+           " \"os_profile\": %s, \"os_alloc_track\": %s,\n \"runs\": [\n",
+           VERSION, __VERSION__,
+#ifdef OS_PROFILE
+           "true",
+#else
+           "false",
+#endif
+#ifdef OS_ALLOC_TRACK
+           "true"
+#else
+           "false"
+#endif
+           );
+    fflush(stdout);
+
+    int rc = 0;
+    bool first = true;
+    for (int sc : n_sc) for (int jw : n_jw) for (int st : n_st) for (int an : n_an) for (int dg : n_dgs) {
+        SynthWorldCfg cfg = base;
+        cfg.n_sceneries = std::max(sc, 1);
+        cfg.n_jetways = jw;
+        cfg.n_stands = std::max(st, 1);
+        cfg.n_anims = an;
+        cfg.n_dgs = dg;
+
+        if (!first)
+            printf(",\n");
+        fflush(stdout);
+        first = false;
+
+        pid_t pid = fork();
+        // exit() as the profile of a -fprofile-generate build is written at exit
+        if (pid == 0)
+            exit(run_world(opt, cfg));
+
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "run failed: sceneries: %d, jetways: %d, stands: %d, anims: %d, dgs: %d\n",
+                    sc, jw, st, an, dg);
+            printf("  {\"error\": \"run failed\"}");
+            rc = 1;
+        }
+    }
+
+    printf("\n]}\n");
+    return rc;
+}
@@ -0,0 +1,151 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Check of the acf_*.txt exception lists:
+//
+//   os_acfpolicy [-v] [-p pkg_dir]
+//
+// The package is copied into a synthetic X-Plane tree with test versions of
+// acf_use_engine_running.txt and acf_dont_connect_jetway.txt. Then planes
+// with 3 and 4 char icao codes are loaded and the applied policy is compared.
+// Exit code is the number of failed cases.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+#include <unistd.h>
+
+#include "openSAM.h"
+#include "plane.h"
+
+#include "xplm_standin.h"
+#include "synth_world.h"
+
+namespace fs = std::filesystem;
+
+static const char *kUseEngineRunning =
+    "# comment with MD11\n"
+    "MD11\n"
+    "R22\r\n"
+    "  DH8D  trailing text\n"
+    "A3\n";
+
+static const char *kDontConnectJetway =
+    "#B738\n"
+    "B738 \n";
+
+static const struct {
+    const char *icao;
+    bool use_engines_on, dont_connect_jetway;
+} cases[] = {
+    {"MD11", true, false},
+    {"R22", true, false},       // 3 chars
+    {"DH8D", true, false},
+    {"B738", false, true},
+    {"A320", false, false},     // "A3" is not a prefix match
+    {"R2", false, false},
+    {"C172", false, false},
+};
+
+static bool
+write_file(const fs::path& fn, const char *content)
+{
+    FILE *f = fopen(fn.string().c_str(), "wb");
+    if (f == nullptr)
+        return false;
+    fputs(content, f);
+    return fclose(f) == 0;
+}
+
+int
+main(int argc, char **argv)
+{
+    bool verbose = false;
+    std::string pkg_dir{"openSAM-pkg/openSAM"};
+
+    int c;
+    while ((c = getopt(argc, argv, "vp:")) != -1) {
+        switch (c) {
+            case 'v': verbose = true; break;
+            case 'p': pkg_dir = optarg; break;
+            default:
+                fprintf(stderr, "usage: os_acfpolicy [-v] [-p pkg_dir]\n");
+                return 2;
+        }
+    }
+
+    SynthWorldCfg cfg;
+    cfg.n_sceneries = 1;
+    cfg.n_jetways = cfg.n_stands = cfg.n_dgs = 2;
+    cfg.n_anims = 0;
+    SynthWorld world = synth_world_generate(cfg);
+
+    std::string dir = synth_mkdtemp("os_acfpolicy");
+    if (dir.empty() || !synth_world_write(world, dir, "")) {
+        fprintf(stderr, "can't write synthetic world\n");
+        return 1;
+    }
+
+    // a private copy of the package with the test lists
+    fs::path plugin_dir = fs::path(dir) / "Resources" / "plugins" / "openSAM";
+    std::error_code ec;
+    fs::create_directories(fs::path(dir) / "Output" / "preferences", ec);
+    fs::create_directories(plugin_dir, ec);
+    fs::copy(pkg_dir, plugin_dir, fs::copy_options::recursive | fs::copy_options::overwrite_existing, ec);
+    if (ec
+        || !write_file(plugin_dir / "acf_use_engine_running.txt", kUseEngineRunning)
+        || !write_file(plugin_dir / "acf_dont_connect_jetway.txt", kDontConnectJetway)) {
+        fprintf(stderr, "can't set up package in '%s'\n", plugin_dir.string().c_str());
+        return 1;
+    }
+
+    const SynthScenery& home = world.sceneries[0];
+    xps_quiet(!verbose);
+    xps_set_xp_dir(dir);
+    xps_set_ref(home.lat, home.lon);
+    xps_place_plane(home.lat, home.lon, 0.0f);
+
+    if (!xps_plugin_start()) {
+        fprintf(stderr, "XPluginStart failed\n");
+        return 1;
+    }
+
+    int n_fail = 0;
+    for (auto& tc : cases) {
+        xps_set_str("sim/aircraft/view/acf_ICAO", tc.icao);
+        xps_message(XPLM_MSG_PLANE_LOADED);
+
+        bool ok = (my_plane.use_engines_on() == tc.use_engines_on
+                   && my_plane.dont_connect_jetway_ == tc.dont_connect_jetway);
+        printf("%-4s use_engines_on: %d, dont_connect_jetway: %d %s\n", tc.icao,
+               my_plane.use_engines_on(), my_plane.dont_connect_jetway_, ok ? "ok" : "FAILED");
+        n_fail += !ok;
+    }
+
+    xps_plugin_stop();
+    fs::remove_all(dir, ec);
+    return n_fail;
+}
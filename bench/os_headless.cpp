@@ -0,0 +1,91 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Run the unmodified plugin headless against the XPLM stand-in:
+//
+//   os_headless [-q] xp_dir [frames [lat lon psi]]
+//
+// xp_dir must contain Resources/plugins/openSAM/ and
+// Custom Scenery/scenery_packs.ini with openSAM_Library.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+
+#include "openSAM.h"
+#include "xplm_standin.h"
+
+int
+main(int argc, char **argv)
+{
+    int ai = 1;
+    if (ai < argc && strcmp(argv[ai], "-q") == 0) {
+        xps_quiet(true);
+        ai++;
+    }
+
+    if (ai >= argc) {
+        fprintf(stderr, "usage: os_headless [-q] xp_dir [frames [lat lon psi]]\n");
+        return 2;
+    }
+
+    std::string dir(argv[ai++]);
+    if (dir.back() != '/')
+        dir += '/';
+
+    int frames = (ai < argc) ? atoi(argv[ai++]) : 300;
+    double lat = 0.0, lon = 0.0;
+    float psi = 0.0f;
+    if (ai + 2 < argc) {
+        lat = atof(argv[ai++]);
+        lon = atof(argv[ai++]);
+        psi = atof(argv[ai++]);
+    }
+
+    xps_set_xp_dir(dir);
+    xps_set_ref(lat, lon);
+    xps_place_plane(lat, lon, psi);
+
+    if (!xps_plugin_start()) {
+        fprintf(stderr, "XPluginStart failed\n");
+        return 1;
+    }
+
+    xps_message(XPLM_MSG_PLANE_LOADED);
+    xps_message(XPLM_MSG_AIRPORT_LOADED);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i++)
+        xps_run_frame(1.0f / 30.0f);
+    auto t1 = std::chrono::steady_clock::now();
+
+    xps_plugin_stop();
+
+    double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+    printf("sceneries: %d, datarefs: %d, instances: %d\n",
+           (int)sceneries.size(), xps_n_datarefs(), xps_n_instances());
+    printf("%d frames in %0.1f ms, %0.2f us/frame\n", frames, us / 1000.0, frames ? us / frames : 0.0);
+    return 0;
+}
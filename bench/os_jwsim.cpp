@@ -0,0 +1,531 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Deterministic jetway animation simulator.
+//
+//   os_jwsim [-v] [-r repeats] [-s scenario] [-c golden | -w golden]
+//
+// Synthetic jetways are put around a plane with a synthetic door layout,
+// no sceneries are read and the plugin is not started.
+// Each scenario is run at a fixed dt in two ways:
+//  - drive: JwCtrl::dock_drive() / undock_drive() of each jetway for its door
+//  - plane: the full Plane::jw_state_machine() from parked to docked and back to idle,
+//           called as scheduled by its return value
+//
+// Time to dock/undock, steps and timeouts hit are the behaviour, it is compared
+// with (-c) or written to (-w) a golden file. The behaviour plus ns per step goes
+// as JSON to stdout. Exit code is 1 if the behaviour differs from the golden file.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "openSAM.h"
+#include "plane.h"
+#include "samjw.h"
+
+#include "xplm_standin.h"
+
+static constexpr float kFrameDt = 1.0f / 30.0f;
+static constexpr float kMaxSimTime = 600.0f;    // s, per phase
+static constexpr float kDockedTime = 10.0f;     // s, plane mode: time between docked and undock request
+
+// a jetway in the plane frame: x right, z aft, psi relative to the plane's heading
+struct JwDef {
+    float x, z, psi;
+    float height, initial_rot1, initial_rot2, initial_extent, max_extent;
+};
+
+struct Scenario {
+    const char *name;
+    const char *icao;
+    float plane_psi;
+    unsigned n_door;
+    DoorInfo door[kMaxDoor];
+    std::vector<JwDef> jws;
+};
+
+// door layouts
+#define DOORS_A320 1, {{-1.85f, 2.6f, -11.1f}}
+#define DOORS_A321 2, {{-1.85f, 2.6f, -14.0f}, {-1.85f, 2.6f, -6.0f}}
+#define DOORS_B744 2, {{-3.0f, 5.1f, -23.0f}, {-3.1f, 5.1f, -12.0f}}
+#define DOORS_A388 3, {{-3.0f, 5.2f, -24.0f}, {-3.2f, 5.2f, -8.0f}, {-2.9f, 8.0f, -18.0f}}
+
+static const Scenario scenarios[] = {
+    {"a320_straight", "A320", 0.0f, DOORS_A320,
+        {{-26.0f, -11.0f, 90.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f}}},
+    {"a320_angled", "A320", 0.0f, DOORS_A320,
+        {{-24.0f, 4.0f, 40.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f}}},
+    {"a320_heading_237", "A320", 237.0f, DOORS_A320,
+        {{-24.0f, -20.0f, 135.0f, 4.5f, 0.0f, 0.0f, 2.0f, 18.0f}}},
+    {"a320_swing_rot1", "A320", 0.0f, DOORS_A320,
+        {{-22.0f, -30.0f, 180.0f, 4.0f, -60.0f, -20.0f, 0.0f, 18.0f}}},
+    {"a320_soft_match", "A320", 0.0f, DOORS_A320,
+        {{-42.0f, -4.0f, 90.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f}}},
+    {"a320_timeout", "A320", 0.0f, DOORS_A320,
+        {{-44.0f, -2.0f, 90.0f, 4.5f, 60.0f, -30.0f, 0.0f, 18.0f}}},
+    {"a321_two_doors", "A321", 90.0f, DOORS_A321,
+        {{-25.0f, -16.0f, 90.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f},
+         {-25.0f, -4.0f, 90.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f}}},
+    {"b744_two_doors", "B744", 315.0f, DOORS_B744,
+        {{-28.0f, -28.0f, 80.0f, 7.0f, 0.0f, -20.0f, 0.0f, 22.0f},
+         {-26.0f, -8.0f, 100.0f, 7.0f, 0.0f, -40.0f, 0.0f, 22.0f}}},
+    {"a388_three_doors", "A388", 180.0f, DOORS_A388,
+        {{-30.0f, -26.0f, 90.0f, 7.0f, 0.0f, -30.0f, 0.0f, 22.0f},
+         {-28.0f, -6.0f, 90.0f, 7.0f, 0.0f, -30.0f, 0.0f, 22.0f},
+         {-36.0f, -14.0f, 90.0f, 10.0f, 0.0f, -10.0f, 0.0f, 22.0f}}},
+    {"a321_collision", "A321", 0.0f, DOORS_A321,
+        {{-24.0f, -14.0f, 60.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f},
+         {-24.0f, -22.0f, 120.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f},
+         {-25.0f, -2.0f, 90.0f, 4.5f, 0.0f, -30.0f, 0.0f, 18.0f}}},
+};
+
+// result of dock_drive() or undock_drive() until done
+struct DriveRes {
+    float t;
+    unsigned steps;
+    bool timeout;
+    float rot1, rot2, rot3, extent;
+    double ns;
+};
+
+struct PlaneRes {
+    std::string active;         // jetway:door, ...
+    std::string transitions;    // state@t, ...
+    float dock_t, undock_t;
+    unsigned calls, dock_steps, undock_steps, timeouts;
+    bool stuck;
+    double ns;
+};
+
+struct Options {
+    int repeats{5};
+    bool verbose{false};
+    const char *only{nullptr};
+    const char *check_fn{nullptr};
+    const char *write_fn{nullptr};
+};
+
+//
+// a plane in auto mode that takes the dock/undock requests of the driver
+//
+class SimPlane : public Plane {
+    bool dock_req_{false}, undock_req_{false};
+
+  public:
+    SimPlane(const Scenario& s) {
+        icao_ = s.icao;
+        x_ = y_ = z_ = 0.0f;
+        psi_ = s.plane_psi;
+        on_ground_ = parkbrake_set_ = true;
+        n_door_ = s.n_door;
+        for (unsigned i = 0; i < n_door_; i++)
+            door_info_[i] = s.door[i];
+        state_ = IDLE;
+    }
+
+    bool auto_mode() const override { return true; }
+
+    bool dock_requested() override {
+        bool r = dock_req_;
+        dock_req_ = false;
+        return r;
+    }
+
+    bool undock_requested() override {
+        bool r = undock_req_;
+        undock_req_ = false;
+        return r;
+    }
+
+    void request_dock() { dock_req_ = true; }
+    void request_undock() { undock_req_ = true; }
+
+    const std::vector<JwCtrl>& active_jws() const { return active_jws_; }
+};
+
+static Scenery *scenery;
+
+// create the jetways of a scenario in the local frame of a plane at (0, 0, 0)
+static void
+setup_jws(const Scenario& s)
+{
+    for (auto jw : scenery->sam_jws)
+        delete jw;
+    scenery->sam_jws.resize(0);
+
+    float sin_psi = sinf(D2R * s.plane_psi);
+    float cos_psi = cosf(D2R * s.plane_psi);
+
+    for (unsigned i = 0; i < s.jws.size(); i++) {
+        const JwDef& d = s.jws[i];
+        SamJw *jw = new SamJw{};
+        snprintf(jw->name, sizeof(jw->name), "J%u", i);
+        jw->x = cos_psi * d.x - sin_psi * d.z;
+        jw->z = sin_psi * d.x + cos_psi * d.z;
+        jw->psi = RA(d.psi + s.plane_psi);
+        jw->obj_ref_gen = ref_gen;
+
+        jw->height = d.height;
+        jw->wheelPos = 12.0f;
+        jw->cabinPos = 16.0f;
+        jw->cabinLength = 3.0f;
+        jw->wheelDiameter = 1.0f;
+        jw->wheelDistance = 2.5f;
+        jw->minRot1 = -90.0f; jw->maxRot1 = 90.0f;
+        jw->minRot2 = -90.0f; jw->maxRot2 = 90.0f;
+        jw->minRot3 = -6.0f; jw->maxRot3 = 6.0f;
+        jw->minExtent = 0.0f; jw->maxExtent = d.max_extent;
+        jw->minWheels = -5.0f; jw->maxWheels = 5.0f;
+        jw->initialRot1 = d.initial_rot1;
+        jw->initialRot2 = d.initial_rot2;
+        jw->initialRot3 = 0.0f;
+        jw->initialExtent = d.initial_extent;
+        jw->reset();
+        scenery->sam_jws.push_back(jw);
+    }
+}
+
+// step a jetway with dock_drive() or undock_drive() until done
+static DriveRes
+drive(JwCtrl& ajw, bool (JwCtrl::*step)())
+{
+    DriveRes r{};
+    float t0 = now;
+    ajw.setup_dock_undock(t0, false);
+
+    auto c0 = std::chrono::steady_clock::now();
+    while (now - t0 < kMaxSimTime) {
+        now += kFrameDt;
+        r.steps++;
+        bool timeout = now > ajw.timeout_;
+        if ((ajw.*step)()) {
+            r.timeout = timeout;
+            break;
+        }
+    }
+    auto c1 = std::chrono::steady_clock::now();
+
+    r.ns = std::chrono::duration<double, std::nano>(c1 - c0).count();
+    r.t = now - t0;
+    r.rot1 = ajw.jw_->rotate1;
+    r.rot2 = ajw.jw_->rotate2;
+    r.rot3 = ajw.jw_->rotate3;
+    r.extent = ajw.jw_->extent;
+    return r;
+}
+
+// dock + undock each jetway with the door it is listed for
+static void
+run_drive(const Scenario& s, std::vector<DriveRes>& res)
+{
+    setup_jws(s);
+    SimPlane plane(s);
+
+    for (unsigned i = 0; i < scenery->sam_jws.size(); i++) {
+        JwCtrl ajw{};
+        ajw.jw_ = scenery->sam_jws[i];
+        ajw.door_ = std::min(i, s.n_door - 1);
+        ajw.setup_for_door(plane, s.door[ajw.door_]);
+
+        now = 0.0f;
+        res.push_back(drive(ajw, &JwCtrl::dock_drive));
+        res.push_back(drive(ajw, &JwCtrl::undock_drive));
+        ajw.reset();
+    }
+}
+
+// parked -> docked -> idle through the state machine
+static PlaneRes
+run_plane(const Scenario& s)
+{
+    PlaneRes r{};
+    setup_jws(s);
+    SimPlane plane(s);
+
+    now = 0.0f;
+    float next_ts = 0.0f, docked_ts = 0.0f, phase_ts = 0.0f;
+    Plane::State prev = plane.state();
+    std::vector<float> tmo;     // timeouts of the active jetways in DOCKING, UNDOCKING
+    std::vector<bool> done;
+    double ns = 0.0;
+
+    while (true) {
+        now += kFrameDt;
+        if (now - phase_ts > kMaxSimTime) {
+            r.stuck = true;
+            break;
+        }
+
+        if (now < next_ts)
+            continue;
+
+        Plane::State st = plane.state();
+        if (st == Plane::CAN_DOCK)
+            plane.request_dock();
+        else if (st == Plane::DOCKED && now >= docked_ts + kDockedTime)
+            plane.request_undock();
+
+        auto c0 = std::chrono::steady_clock::now();
+        float delay = plane.jw_state_machine();
+        auto c1 = std::chrono::steady_clock::now();
+        ns += std::chrono::duration<double, std::nano>(c1 - c0).count();
+        r.calls++;
+
+        // the flight loop: negative = frames, positive = seconds
+        next_ts = delay > 0.0f ? now + delay : now;
+
+        st = plane.state();
+        if (st == Plane::DOCKING)
+            r.dock_steps++;
+        else if (st == Plane::UNDOCKING)
+            r.undock_steps++;
+
+        // A jetway that finishes after its timeout has been forced into place.
+        // Active jetways are gone when the state machine gets back to IDLE.
+        auto& ajws = plane.active_jws();
+        bool phase_end = (st != prev && (st == Plane::DOCKED || st == Plane::IDLE));
+        if (prev == Plane::DOCKING || prev == Plane::UNDOCKING)
+            for (unsigned i = 0; i < tmo.size(); i++) {
+                bool d = phase_end;
+                if (i < ajws.size())
+                    d = d || ajws[i].state_ == (prev == Plane::DOCKING ? JwCtrl::DOCKED : JwCtrl::PARKED);
+                if (d && !done[i] && now > tmo[i])
+                    r.timeouts++;
+                done[i] = done[i] || d;
+            }
+
+        if (st == prev)
+            continue;
+
+        char buf[40];
+        snprintf(buf, sizeof(buf), "%s%s@%0.2f", r.transitions.empty() ? "" : ",",
+                 Plane::state_str_[st], now);
+        r.transitions += buf;
+
+        if (st == Plane::CAN_DOCK) {
+            for (auto& ajw : ajws) {
+                snprintf(buf, sizeof(buf), "%s%s:%d", r.active.empty() ? "" : ",",
+                         ajw.jw_->name, ajw.door_);
+                r.active += buf;
+            }
+        } else if (st == Plane::DOCKING || st == Plane::UNDOCKING) {
+            phase_ts = now;
+            tmo.resize(0);
+            for (auto& ajw : ajws)
+                tmo.push_back(ajw.timeout_);
+            done.assign(tmo.size(), false);
+        } else if (st == Plane::DOCKED) {
+            r.dock_t = now - phase_ts;
+            docked_ts = now;
+        } else if (st == Plane::IDLE || st == Plane::CANT_DOCK) {
+            if (prev == Plane::UNDOCKING)
+                r.undock_t = now - phase_ts;
+            break;
+        }
+
+        prev = st;
+    }
+
+    r.ns = ns;
+    return r;
+}
+
+static std::string
+drive_line(const Scenario& s, unsigned jw, const DriveRes& d, const DriveRes& u)
+{
+    char buf[300];
+    snprintf(buf, sizeof(buf),
+             "drive %s J%u dock t=%0.2f steps=%u timeout=%d rot1=%0.2f rot2=%0.2f rot3=%0.2f extent=%0.2f"
+             " undock t=%0.2f steps=%u timeout=%d",
+             s.name, jw, d.t, d.steps, d.timeout, d.rot1, d.rot2, d.rot3, d.extent,
+             u.t, u.steps, u.timeout);
+    return buf;
+}
+
+static std::string
+plane_line(const Scenario& s, const PlaneRes& p)
+{
+    char buf[100];
+    snprintf(buf, sizeof(buf), " dock t=%0.2f steps=%u undock t=%0.2f steps=%u calls=%u timeouts=%u stuck=%d",
+             p.dock_t, p.dock_steps, p.undock_t, p.undock_steps, p.calls, p.timeouts, p.stuck);
+    return std::string("plane ") + s.name + " active=" + (p.active.empty() ? "-" : p.active)
+           + " states=" + p.transitions + buf;
+}
+
+// compare behaviour with the golden file, print differences to stderr
+static bool
+check_golden(const char *fn, const std::vector<std::string>& lines, bool all)
+{
+    FILE *f = fopen(fn, "r");
+    if (f == nullptr) {
+        fprintf(stderr, "can't open '%s'\n", fn);
+        return false;
+    }
+
+    std::vector<std::string> golden;
+    char buf[1024];
+    while (fgets(buf, sizeof(buf), f)) {
+        buf[strcspn(buf, "\r\n")] = '\0';
+        if (buf[0] && buf[0] != '#')
+            golden.push_back(buf);
+    }
+    fclose(f);
+
+    bool ok = true;
+    for (auto& l : lines)
+        if (std::find(golden.begin(), golden.end(), l) == golden.end()) {
+            fprintf(stderr, "new: %s\n", l.c_str());
+            ok = false;
+        }
+
+    // with a scenario selected there are no lines for the others
+    if (all)
+        for (auto& g : golden)
+            if (std::find(lines.begin(), lines.end(), g) == lines.end()) {
+                fprintf(stderr, "golden: %s\n", g.c_str());
+                ok = false;
+            }
+
+    return ok;
+}
+
+static void
+usage()
+{
+    fprintf(stderr, "usage: os_jwsim [-v] [-r repeats] [-s scenario] [-c golden | -w golden]\n");
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    Options opt;
+
+    int c;
+    while ((c = getopt(argc, argv, "vr:s:c:w:")) != -1) {
+        switch (c) {
+            case 'v': opt.verbose = true; break;
+            case 'r': opt.repeats = std::max(1, atoi(optarg)); break;
+            case 's': opt.only = optarg; break;
+            case 'c': opt.check_fn = optarg; break;
+            case 'w': opt.write_fn = optarg; break;
+            default: usage();
+        }
+    }
+
+    if (optind != argc || (opt.check_fn && opt.write_fn))
+        usage();
+
+    xps_quiet(!opt.verbose);
+
+    // start in a valid reference frame, the jetways count as drawn in it
+    check_ref_frame_shift();
+    scenery = new Scenery();
+    strcpy(scenery->name, "JWSIM");
+    sceneries.push_back(scenery);
+
+    printf("{\"benchmark\": \"jwsim\", \"version\": \"%s\", \"compiler\": \"%s\", \"dt\": %0.6f,\n"
+           " \"scenarios\": [",
+           VERSION, __VERSION__, kFrameDt);
+
+    std::vector<std::string> lines;
+    bool first = true;
+    for (auto& s : scenarios) {
+        if (opt.only && strcmp(opt.only, s.name))
+            continue;
+
+        // behaviour from the first run, best time of all
+        std::vector<DriveRes> dr;
+        PlaneRes pr{};
+        for (int i = 0; i < opt.repeats; i++) {
+            std::vector<DriveRes> d;
+            run_drive(s, d);
+            PlaneRes p = run_plane(s);
+            if (i == 0) {
+                dr = d;
+                pr = p;
+                continue;
+            }
+
+            for (unsigned k = 0; k < dr.size(); k++)
+                dr[k].ns = std::min(dr[k].ns, d[k].ns);
+            pr.ns = std::min(pr.ns, p.ns);
+        }
+
+        printf("%s\n  {\"name\": \"%s\", \"icao\": \"%s\", \"doors\": %u, \"jetways\": %zu,\n   \"drive\": [",
+               first ? "" : ",", s.name, s.icao, s.n_door, s.jws.size());
+        first = false;
+
+        for (unsigned k = 0; k < dr.size(); k += 2) {
+            const DriveRes& d = dr[k];
+            const DriveRes& u = dr[k + 1];
+            lines.push_back(drive_line(s, k / 2, d, u));
+            printf("%s\n    {\"jetway\": \"J%u\", \"dock_s\": %0.2f, \"dock_steps\": %u, \"dock_timeout\": %s,"
+                   " \"undock_s\": %0.2f, \"undock_steps\": %u, \"undock_timeout\": %s,"
+                   " \"dock_ns_per_step\": %0.1f, \"undock_ns_per_step\": %0.1f}",
+                   k ? "," : "", k / 2, d.t, d.steps, d.timeout ? "true" : "false",
+                   u.t, u.steps, u.timeout ? "true" : "false",
+                   d.steps ? d.ns / d.steps : 0.0, u.steps ? u.ns / u.steps : 0.0);
+        }
+
+        lines.push_back(plane_line(s, pr));
+        printf("],\n   \"plane\": {\"active\": \"%s\", \"dock_s\": %0.2f, \"dock_steps\": %u,"
+               " \"undock_s\": %0.2f, \"undock_steps\": %u, \"calls\": %u, \"timeouts\": %u,"
+               " \"stuck\": %s, \"ns_per_call\": %0.1f}}",
+               pr.active.c_str(), pr.dock_t, pr.dock_steps, pr.undock_t, pr.undock_steps,
+               pr.calls, pr.timeouts, pr.stuck ? "true" : "false", pr.calls ? pr.ns / pr.calls : 0.0);
+        fflush(stdout);
+    }
+
+    int rc = 0;
+    const char *golden = "null";
+    if (opt.check_fn) {
+        bool ok = check_golden(opt.check_fn, lines, opt.only == nullptr);
+        golden = ok ? "\"match\"" : "\"mismatch\"";
+        rc = ok ? 0 : 1;
+    }
+
+    if (opt.write_fn) {
+        FILE *f = fopen(opt.write_fn, "w");
+        if (f == nullptr) {
+            fprintf(stderr, "can't create '%s'\n", opt.write_fn);
+            return 1;
+        }
+        fprintf(f, "# os_jwsim golden output, regenerate with: os_jwsim -w <file>\n");
+        for (auto& l : lines)
+            fprintf(f, "%s\n", l.c_str());
+        fclose(f);
+    }
+
+    printf("\n ],\n \"golden\": %s}\n", golden);
+    return rc;
+}
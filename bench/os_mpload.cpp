@@ -0,0 +1,471 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Multiplayer load test with stand-in traffic providers.
+//
+//   os_mpload [-v] [-k] [-p pkg_dir] [-n aircraft] [-t providers] [-w window] [-s tcas_slots]
+//
+// -n takes a comma separated list of aircraft counts, -t a comma separated list
+// of provider sets out of tgxp, xpilot, lt and all (= the three mixed).
+// Each combination runs in a forked process on a synthetic airport with one
+// dockable stand per aircraft, our plane sits on the ground in the middle.
+// The aircraft arrive within the window, park, start up and push back,
+// see traffic_standin.h.
+//
+// The MP part of the flight loop is run by the harness with its own adapter
+// so MpAdapter::update(), jw_localize_pass() and MpAdapter::jw_state_machine()
+// can be timed. Spawn latency is sim time from when an aircraft could be
+// spawned (parked, any time for xPilot) until it is live, docking time is
+// from parking until docked. An aircraft undocks late if its jetways
+// still move or are attached when it pushes back.
+//
+// Results go as JSON to stdout.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "openSAM.h"
+#include "plane.h"
+#include "samjw.h"
+#include "mpadapter.h"
+
+#include "xplm_standin.h"
+#include "synth_world.h"
+#include "traffic_standin.h"
+
+static constexpr float kFrameDt = 1.0f / 30.0f;
+static constexpr double kM_per_deg = 111120.0;
+static constexpr double kRowSpacing = 150.0;    // as in synth_world
+
+// script of an aircraft, s
+static constexpr float kTaxiTime = 30.0f;
+static constexpr float kParkTime = 150.0f;      // + up to kParkJitter
+static constexpr float kParkJitter = 90.0f;
+static constexpr float kStartupTime = 40.0f;
+
+struct AcType {
+    const char *icao;
+    const char *tgxp_code;
+};
+
+static const AcType ac_types[] = {
+    {"A320", "320_SYNTH"}, {"A321", "321_SYNTH"}, {"B738", "738_SYNTH"},
+    {"A333", "333_SYNTH"}, {"B744", "744_SYNTH"}
+};
+
+struct Options {
+    bool keep{false};
+    bool verbose{false};
+    float window{120.0f};       // s, arrivals
+    int tcas_slots{64};
+    std::string pkg_dir{"openSAM-pkg/openSAM"};
+};
+
+// a provider set
+struct Mix {
+    std::string name;
+    std::vector<TsProvider> providers;
+};
+
+// per aircraft
+struct AcTrack {
+    float live_t{-1.0f};        // first time seen as live plane
+    float docked_t{-1.0f};      // first time docked
+    float busy_t{-1.0f};        // last time docking, docked or undocking
+    bool in_range;
+};
+
+// wall time samples of a call
+struct Timing {
+    std::vector<float> us;
+
+    void add(std::chrono::steady_clock::time_point t0) {
+        us.push_back(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - t0).count());
+    }
+};
+
+static float
+pct(std::vector<float> v, int p)
+{
+    if (v.empty())
+        return 0.0f;
+    auto it = v.begin() + std::min((int)v.size() - 1, (int)v.size() * p / 100);
+    std::nth_element(v.begin(), it, v.end());
+    return *it;
+}
+
+static void
+print_timing(const char *name, const Timing& t, bool last = false)
+{
+    double sum = 0.0;
+    for (float u : t.us)
+        sum += u;
+    float max = t.us.empty() ? 0.0f : *std::max_element(t.us.begin(), t.us.end());
+    printf("    \"%s\": {\"calls\": %d, \"us_mean\": %0.2f, \"us_p50\": %0.2f, \"us_p99\": %0.2f, "
+           "\"us_max\": %0.2f}%s\n", name, (int)t.us.size(), t.us.empty() ? 0.0 : sum / t.us.size(),
+           pct(t.us, 50), pct(t.us, 99), max, last ? "" : ",");
+}
+
+static void
+print_dist(const char *name, const std::vector<float>& v, bool last = false)
+{
+    float max = v.empty() ? 0.0f : *std::max_element(v.begin(), v.end());
+    printf("\"%s\": {\"p50\": %0.1f, \"p90\": %0.1f, \"p99\": %0.1f, \"max\": %0.1f}%s",
+           name, pct(v, 50), pct(v, 90), pct(v, 99), max, last ? "" : ", ");
+}
+
+static int
+run_load(const Options& opt, int n_ac, const Mix& mix)
+{
+    // one airport, a dockable stand per aircraft in a square that fits into kMpMaxDist
+    SynthWorldCfg cfg;
+    cfg.n_sceneries = 1;
+    cfg.n_jetways = cfg.n_stands = n_ac;
+    cfg.n_dgs = cfg.n_anims = cfg.n_auto = 0;
+    cfg.stands_per_row = (int)ceil(sqrt(3.0 * n_ac));
+    cfg.dock_jws = true;
+
+    SynthWorld world = synth_world_generate(cfg);
+    std::string dir = synth_mkdtemp("os_mpload");
+    if (dir.empty() || !synth_world_write(world, dir, opt.pkg_dir)) {
+        fprintf(stderr, "can't write synthetic world\n");
+        return 1;
+    }
+
+    const SynthScenery& home = world.sceneries[0];
+    int n_rows = (n_ac + cfg.stands_per_row - 1) / cfg.stands_per_row;
+
+    xps_quiet(!opt.verbose);
+    xps_set_xp_dir(dir);
+    xps_set_aircraft(dir + "Aircraft/A320/A320.acf");
+    xps_add_airport(home.name.c_str(), home.lat, home.lon, 0.0f);
+
+    // our plane on ground between the middle rows with the beacon on, it does not dock
+    double my_z = (n_rows - 1) * kRowSpacing / 2 + kRowSpacing / 2;
+    double my_lat = home.lat - my_z / kM_per_deg;
+    xps_set_ref(home.lat, home.lon);
+    xps_place_plane(my_lat, home.lon, 0.0f);
+    xps_set("sim/flightmodel/forces/fnrml_gear", 50000.0);
+    xps_set("sim/cockpit2/switches/beacon_on", 1);
+    xps_set_vi("sim/flightmodel/engine/ENGN_running", {1, 1});
+    xps_set_str("sim/aircraft/view/acf_ICAO", "A320");
+    xps_set_vf("sim/aircraft/parts/acf_gear_znodef", {-12.6f, 1.5f});
+
+    if (!xps_plugin_start()) {
+        fprintf(stderr, "XPluginStart failed\n");
+        return 1;
+    }
+
+    xps_message(XPLM_MSG_PLANE_LOADED);
+    xps_message(XPLM_MSG_AIRPORT_LOADED);
+    for (int i = 0; i < 60; i++)
+        xps_run_frame(kFrameDt);
+
+    // the script, deterministic
+    std::mt19937 rng(4711);
+    std::uniform_real_distribution<float> jitter(0.0f, kParkJitter);
+    float t0 = xps_time();
+    float t_end = t0;
+    float t_adapter = t0;
+    float first_arrival[kTsNum];
+    std::fill(first_arrival, first_arrival + kTsNum, -1.0f);
+    std::vector<TsAircraft> traffic;
+    std::vector<AcTrack> track(n_ac);
+
+    for (int k = 0; k < n_ac; k++) {
+        const AcType& type = ac_types[k % std::size(ac_types)];
+        const DoorInfoRec *dir = csl_door_info_table.find(type.icao);
+        if (dir == nullptr) {
+            fprintf(stderr, "no door info for '%s'\n", type.icao);
+            return 1;
+        }
+
+        const SynthObj& stand = home.stands[k];
+        TsAircraft ac;
+        ac.provider = mix.providers[k % mix.providers.size()];
+        char fid[8];
+        snprintf(fid, sizeof(fid), "SYN%04d", k);
+        ac.flight_id = fid;
+        ac.icao = type.icao;
+        ac.tgxp_code = type.tgxp_code;
+        ac.lat = stand.lat - synth_stop_z(dir->door[0].z) / kM_per_deg;
+        ac.lon = stand.lon;
+        ac.psi = stand.psi;
+        ac.t_arrive = t0 + opt.window * k / n_ac;
+        ac.t_park = ac.t_arrive + kTaxiTime;
+        ac.t_startup = ac.t_park + kParkTime + jitter(rng);
+        ac.t_depart = ac.t_startup + kStartupTime;
+        ac.t_gone = ac.t_depart + kTaxiTime;
+        traffic.push_back(ac);
+
+        t_end = std::max(t_end, ac.t_gone + 5.0f);
+        if (first_arrival[ac.provider] < 0.0f) {
+            first_arrival[ac.provider] = ac.t_arrive;
+            t_adapter = std::max(t_adapter, ac.t_arrive);
+        }
+
+        double dlat = (ac.lat - my_lat) * kM_per_deg;
+        double dlon = (ac.lon - home.lon) * kM_per_deg * cos(home.lat * M_PI / 180.0);
+        track[k].in_range = sqrt(dlat * dlat + dlon * dlon) <= kMpMaxDist;
+    }
+
+    std::unordered_map<std::string, int> ac_idx;
+    for (int k = 0; k < n_ac; k++)
+        ac_idx[traffic[k].flight_id] = k;
+
+    ts_init(traffic, opt.tcas_slots);
+
+    // the MP part of the flight loop
+    std::unique_ptr<MpAdapter> adapter;
+    Timing t_update, t_localize, t_jw, t_frame;
+    float update_next_ts = 0.0f, loc_next_ts = 0.0f, jw_next_ts = 0.0f;
+    std::vector<const MpPlane *> planes;
+    unsigned peak_live = 0;
+
+    while (xps_time() < t_end) {
+        xps_run_frame(kFrameDt);
+        now = xps_time();
+        ts_update(now);
+
+        if (adapter == nullptr) {
+            if (now < t_adapter)
+                continue;
+
+            adapter = MpAdapter_factory();
+            if (adapter == nullptr) {
+                fprintf(stderr, "no MP adapter\n");
+                return 1;
+            }
+        }
+
+        auto tf = std::chrono::steady_clock::now();
+        if (now >= update_next_ts) {
+            auto tc = std::chrono::steady_clock::now();
+            update_next_ts = now + adapter->update();
+            t_update.add(tc);
+        }
+
+        if (now >= loc_next_ts) {
+            auto tc = std::chrono::steady_clock::now();
+            loc_next_ts = now + jw_localize_pass();
+            t_localize.add(tc);
+        }
+
+        if (now >= jw_next_ts) {
+            auto tc = std::chrono::steady_clock::now();
+            jw_next_ts = now + adapter->jw_state_machine();
+            t_jw.add(tc);
+        }
+        t_frame.add(tf);
+
+        planes.clear();
+        adapter->live_planes(planes);
+        peak_live = std::max(peak_live, (unsigned)planes.size());
+        for (auto p : planes) {
+            auto it = ac_idx.find(p->flight_id());
+            if (it == ac_idx.end())
+                continue;
+
+            AcTrack& tr = track[it->second];
+            if (tr.live_t < 0.0f)
+                tr.live_t = now;
+
+            Plane::State s = p->state();
+            if (s == Plane::DOCKED && tr.docked_t < 0.0f)
+                tr.docked_t = now;
+            if (s == Plane::DOCKING || s == Plane::DOCKED || s == Plane::UNDOCKING)
+                tr.busy_t = now;
+        }
+    }
+
+    std::string personality = adapter ? adapter->personality() : "";
+    adapter = nullptr;
+    xps_plugin_stop();
+
+    if (!opt.keep)
+        std::filesystem::remove_all(dir);
+
+    printf("  {\"aircraft\": %d, \"providers\": \"%s\", \"adapter\": \"%s\", \"stands_per_row\": %d, "
+           "\"sim_time\": %0.0f, \"peak_live\": %u, \"dropped\": %d,\n",
+           n_ac, mix.name.c_str(), personality.c_str(), cfg.stands_per_row, t_end - t0, peak_live,
+           ts_dropped());
+    printf("   \"timing\": {\n");
+    print_timing("update", t_update);
+    print_timing("jw_localize_pass", t_localize);
+    print_timing("jw_state_machine", t_jw);
+    print_timing("mp_frame", t_frame, true);
+    printf("   },\n   \"per_provider\": {");
+
+    bool first = true;
+    for (TsProvider prov : mix.providers) {
+        int n = 0, n_range = 0, n_live = 0, n_docked = 0, n_late = 0;
+        std::vector<float> spawn, dock;
+        for (int k = 0; k < n_ac; k++) {
+            const TsAircraft& ac = traffic[k];
+            const AcTrack& tr = track[k];
+            if (ac.provider != prov)
+                continue;
+
+            n++;
+            n_range += tr.in_range;
+            if (tr.live_t >= 0.0f) {
+                n_live++;
+                float eligible = (prov == kTsXpilot ? ac.t_arrive : ac.t_park);
+                spawn.push_back(std::max(tr.live_t - eligible, 0.0f));
+            }
+
+            if (tr.docked_t >= 0.0f) {
+                n_docked++;
+                dock.push_back(tr.docked_t - ac.t_park);
+                if (tr.busy_t >= ac.t_depart)
+                    n_late++;
+            }
+        }
+
+        printf("%s\n    \"%s\": {\"aircraft\": %d, \"in_range\": %d, \"spawned\": %d, \"docked\": %d, "
+               "\"docked_fraction\": %0.3f, \"undocked_late\": %d,\n     ",
+               first ? "" : ",", ts_provider_name(prov), n, n_range, n_live, n_docked,
+               n_range ? (double)n_docked / n_range : 0.0, n_late);
+        print_dist("spawn_latency_s", spawn);
+        print_dist("dock_time_s", dock, true);
+        printf("}");
+        first = false;
+    }
+    printf("}}");
+    fflush(stdout);
+    return 0;
+}
+
+static std::vector<int>
+int_list(const char *arg)
+{
+    std::vector<int> l;
+    for (const char *s = arg; *s; ) {
+        l.push_back(atoi(s));
+        s = strchr(s, ',');
+        if (s == nullptr)
+            break;
+        s++;
+    }
+    return l;
+}
+
+static std::vector<Mix>
+mix_list(const char *arg)
+{
+    std::vector<Mix> l;
+    std::string s(arg);
+    size_t start = 0;
+    while (start <= s.size()) {
+        size_t pos = s.find(',', start);
+        if (pos == std::string::npos)
+            pos = s.size();
+
+        Mix m;
+        m.name = s.substr(start, pos - start);
+        for (int p = 0; p < kTsNum; p++)
+            if (m.name == "all" || m.name == ts_provider_name((TsProvider)p))
+                m.providers.push_back((TsProvider)p);
+
+        if (m.providers.empty()) {
+            fprintf(stderr, "unknown provider '%s'\n", m.name.c_str());
+            exit(2);
+        }
+
+        l.push_back(m);
+        start = pos + 1;
+    }
+    return l;
+}
+
+static void
+usage()
+{
+    fprintf(stderr, "usage: os_mpload [-v] [-k] [-p pkg_dir] [-n aircraft] [-t providers] [-w window] "
+                    "[-s tcas_slots]\n");
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    Options opt;
+    std::vector<int> n_ac{50, 200, 1000};
+    std::vector<Mix> mixes = mix_list("tgxp,xpilot,lt,all");
+
+    int c;
+    while ((c = getopt(argc, argv, "vkp:n:t:w:s:")) != -1) {
+        switch (c) {
+            case 'v': opt.verbose = true; break;
+            case 'k': opt.keep = true; break;
+            case 'p': opt.pkg_dir = optarg; break;
+            case 'n': n_ac = int_list(optarg); break;
+            case 't': mixes = mix_list(optarg); break;
+            case 'w': opt.window = atof(optarg); break;
+            case 's': opt.tcas_slots = std::max(atoi(optarg), 2); break;
+            default: usage();
+        }
+    }
+
+    printf("{\"benchmark\": \"mpload\", \"version\": \"%s\", \"compiler\": \"%s\",\n"
+           " \"window\": %0.0f, \"tcas_slots\": %d,\n \"runs\": [\n",
+           VERSION, __VERSION__, opt.window, opt.tcas_slots);
+    fflush(stdout);
+
+    int rc = 0;
+    bool first = true;
+    for (int n : n_ac) for (auto& mix : mixes) {
+        if (!first)
+            printf(",\n");
+        fflush(stdout);
+        first = false;
+
+        pid_t pid = fork();
+        // exit() as the profile of a -fprofile-generate build is written at exit
+        if (pid == 0)
+            exit(run_load(opt, std::max(n, 1), mix));
+
+        int status;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "run failed: aircraft: %d, providers: %s\n", n, mix.name.c_str());
+            printf("  {\"error\": \"run failed\"}");
+            rc = 1;
+        }
+    }
+
+    printf("\n]}\n");
+    return rc;
+}
@@ -0,0 +1,442 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+//
+// Replay a session recorded by a plugin built with -DOS_ACC_RECORD:
+//
+//   os_replay [-q] [-m max_shown] xp_dir trace
+//
+// xp_dir must have the same sceneries as the recording session.
+// The plugin runs on the XPLM stand-in, flight loops are called when they
+// were called in the session with the recorded plane state, coordinate
+// transformations and probes return the recorded results.
+// Each accessor call is repeated and its result is compared bit by bit.
+//
+// Not recorded: multiplayer traffic and the manual jetway selection in the UI.
+// Sessions using them replay up to the first divergence.
+//
+// Results go as JSON to stdout, mismatches are listed on stderr.
+// Exit code is 0 if all results are identical.
+//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "XPLMDataAccess.h"
+#include "XPLMPlugin.h"
+
+#include "openSAM.h"
+#include "plane.h"
+#include "os_anim.h"
+#include "os_rec.h"
+#include "xplm_standin.h"
+
+static const char *acc_name[kRecAccNum] = { "jw_anim_acc", "read_dgs_acc", "anim_acc" };
+
+struct AccStat {
+    unsigned long long calls, mismatches;
+    double ns;
+};
+
+using Key3d = std::array<double, 3>;
+using Key3f = std::array<float, 3>;
+
+static std::map<Key3d, Key3d> w2l, l2w;
+static std::map<Key3f, RecProbe> probes;
+static unsigned long long xform_misses;
+
+static bool
+hook_w2l(double lat, double lon, double alt, double *x, double *y, double *z)
+{
+    auto it = w2l.find({lat, lon, alt});
+    if (it == w2l.end()) {
+        xform_misses++;
+        return false;
+    }
+
+    *x = it->second[0]; *y = it->second[1]; *z = it->second[2];
+    return true;
+}
+
+static bool
+hook_l2w(double x, double y, double z, double *lat, double *lon, double *alt)
+{
+    auto it = l2w.find({x, y, z});
+    if (it == l2w.end()) {
+        xform_misses++;
+        return false;
+    }
+
+    *lat = it->second[0]; *lon = it->second[1]; *alt = it->second[2];
+    return true;
+}
+
+static bool
+hook_probe(float x, float y, float z, XPLMProbeResult *res, XPLMProbeInfo_t *info)
+{
+    auto it = probes.find({x, y, z});
+    if (it == probes.end()) {
+        xform_misses++;
+        return false;
+    }
+
+    const RecProbe& p = it->second;
+    *res = p.result;
+    info->locationX = p.loc_x;
+    info->locationY = p.loc_y;
+    info->locationZ = p.loc_z;
+    info->normalX = info->normalZ = 0.0f;
+    info->normalY = 1.0f;
+    info->velocityX = info->velocityY = info->velocityZ = 0.0f;
+    info->is_wet = 0;
+    return true;
+}
+
+static std::vector<uint8_t>
+read_file(const char *fn)
+{
+    std::vector<uint8_t> buf;
+    FILE *f = fopen(fn, "rb");
+    if (f == nullptr)
+        return buf;
+
+    uint8_t tmp[64 * 1024];
+    size_t n;
+    while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0)
+        buf.insert(buf.end(), tmp, tmp + n);
+    fclose(f);
+    return buf;
+}
+
+// sequential reader, false at the end or on a truncated record
+struct Reader {
+    const uint8_t *p, *end;
+
+    template<typename T>
+    bool get(T& v) {
+        if (end - p < (ptrdiff_t)sizeof(T))
+            return false;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool get_leb128(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7f) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+};
+
+static XPLMDataRef obj_x_dr, obj_y_dr, obj_z_dr, obj_psi_dr, plane_lat_dr, plane_lon_dr;
+static float cur_lat_ref = 1.0E10f, cur_lon_ref = 1.0E10f;
+
+static void
+set_frame(const RecFrame& f)
+{
+    if (f.lat_ref != cur_lat_ref || f.lon_ref != cur_lon_ref) {
+        cur_lat_ref = f.lat_ref;
+        cur_lon_ref = f.lon_ref;
+        xps_set_ref(cur_lat_ref, cur_lon_ref);
+    }
+
+    xps_set_time(f.t);
+    XPLMSetDataf(plane_lat_dr, f.lat);
+    XPLMSetDataf(plane_lon_dr, f.lon);
+}
+
+static void
+set_loop_state(const RecLoop& l)
+{
+    set_frame(l.f);
+    xps_set("sim/flightmodel/position/local_x", l.x);
+    xps_set("sim/flightmodel/position/local_y", l.y);
+    xps_set("sim/flightmodel/position/local_z", l.z);
+    xps_set("sim/flightmodel2/position/true_psi", l.psi);
+    xps_set("sim/flightmodel2/position/y_agl", l.y_agl);
+    xps_set("sim/flightmodel/position/elevation", l.elevation);
+    xps_set("sim/flightmodel/forces/fnrml_gear", l.gear_fnrml);
+    xps_set("sim/flightmodel/controls/parkbrake", l.parkbrake);
+    xps_set("sim/cockpit2/switches/beacon_on", l.beacon);
+    xps_set("sim/graphics/scenery/percent_lights_on", l.percent_lights);
+    xps_set("sim/graphics/animation/sin_wave_2", l.sin_wave);
+
+    std::vector<int> eng(l.n_eng);
+    for (int i = 0; i < l.n_eng; i++)
+        eng[i] = (l.eng_running >> i) & 1;
+    xps_set_vi("sim/flightmodel/engine/ENGN_running", eng);
+
+    my_plane.set_requests(l.requests);
+    my_plane.auto_mode_set(l.auto_mode);
+}
+
+static void
+set_plane(const RecPlane& p)
+{
+    xps_set_str("sim/aircraft/view/acf_ICAO", std::string(p.icao, strnlen(p.icao, sizeof(p.icao))));
+    xps_set("sim/aircraft/weight/acf_cgY_original", p.cg_y);
+    xps_set("sim/aircraft/weight/acf_cgZ_original", p.cg_z);
+    xps_set_vf("sim/aircraft/parts/acf_gear_znodef",
+               std::vector<float>(p.gear_z, p.gear_z + std::min<int>(p.n_gear_z, 2)));
+    xps_set("sim/aircraft2/metadata/is_helicopter", p.is_helicopter);
+    xps_set("sim/aircraft/view/acf_door_x", p.door_x);
+    xps_set("sim/aircraft/view/acf_door_y", p.door_y);
+    xps_set("sim/aircraft/view/acf_door_z", p.door_z);
+    xps_set_aircraft(std::string(p.acf_path, strnlen(p.acf_path, sizeof(p.acf_path))));
+}
+
+static void
+usage()
+{
+    fprintf(stderr, "usage: os_replay [-q] [-m max_shown] xp_dir trace\n");
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    int max_shown = 10;
+    int ai;
+    for (ai = 1; ai < argc && argv[ai][0] == '-'; ai++) {
+        if (strcmp(argv[ai], "-q") == 0)
+            xps_quiet(true);
+        else if (strcmp(argv[ai], "-m") == 0 && ai + 1 < argc)
+            max_shown = atoi(argv[++ai]);
+        else
+            usage();
+    }
+
+    if (ai != argc - 2)
+        usage();
+
+    std::string dir(argv[ai]);
+    if (dir.back() != '/')
+        dir += '/';
+
+    const char *trace_fn = argv[ai + 1];
+    std::vector<uint8_t> trace = read_file(trace_fn);
+    Reader rd{trace.data(), trace.data() + trace.size()};
+
+    RecHeader h;
+    if (!rd.get(h) || memcmp(h.magic, kRecMagic, sizeof(kRecMagic))) {
+        fprintf(stderr, "'%s' is not a recorded session\n", trace_fn);
+        return 2;
+    }
+    h.version[sizeof(h.version) - 1] = '\0';
+
+    xps_set_xp_dir(dir);
+    xps_set_xform_hook(XpsXformHook{hook_w2l, hook_l2w, hook_probe});
+
+    if (!xps_plugin_start()) {
+        fprintf(stderr, "XPluginStart failed\n");
+        return 1;
+    }
+
+    unsigned n_jetways = 0, n_stands = 0;
+    for (auto sc : sceneries) {
+        n_jetways += sc->sam_jws.size();
+        n_stands += sc->stands.size();
+    }
+
+    if (h.n_sceneries != sceneries.size() || h.n_jetways != n_jetways || h.n_stands != n_stands
+        || h.n_drfs != sam_drfs.size())
+        fprintf(stderr, "warning: sceneries differ from the recording: "
+                "sceneries %u/%d, jetways %u/%u, stands %u/%u, datarefs %u/%d\n",
+                h.n_sceneries, (int)sceneries.size(), h.n_jetways, n_jetways,
+                h.n_stands, n_stands, h.n_drfs, (int)sam_drfs.size());
+
+    obj_x_dr = XPLMFindDataRef("sim/graphics/animation/draw_object_x");
+    obj_y_dr = XPLMFindDataRef("sim/graphics/animation/draw_object_y");
+    obj_z_dr = XPLMFindDataRef("sim/graphics/animation/draw_object_z");
+    obj_psi_dr = XPLMFindDataRef("sim/graphics/animation/draw_object_psi");
+    plane_lat_dr = XPLMFindDataRef("sim/flightmodel/position/latitude");
+    plane_lon_dr = XPLMFindDataRef("sim/flightmodel/position/longitude");
+
+    // the read functions, for anim_acc() via the dataref of the index
+    XPLMGetDataf_f jw_acc = xps_float_accessor("sam/jetway/rotate1");
+    XPLMGetDataf_f dgs_acc = xps_float_accessor("opensam/dgs/status");
+    std::vector<XPLMGetDataf_f> anim_acc(sam_drfs.size());
+    for (unsigned i = 0; i < sam_drfs.size(); i++)
+        anim_acc[i] = xps_float_accessor(sam_drfs[i]->name);
+
+    AccStat stat[kRecAccNum]{};
+    unsigned long long n_frames = 0, n_loops = 0, n_mp_loops = 0, n_events = 0, n_unknown = 0;
+    unsigned long long mismatches = 0;
+    RecObj obj{};
+    bool truncated = false;
+
+    while (rd.p < rd.end) {
+        uint8_t tag = *rd.p++;
+
+        if (tag & kRecAcc) {
+            int kind = (tag >> 1) & 0x3f;
+            uint64_t ref;
+            float val;
+            if (kind >= kRecAccNum || !rd.get_leb128(ref) || (!(tag & 1) && !rd.get(obj)) || !rd.get(val)) {
+                truncated = true;
+                break;
+            }
+
+            XPLMGetDataf_f acc = (kind == kRecJw) ? jw_acc : (kind == kRecDgs) ? dgs_acc
+                                 : (ref < anim_acc.size() ? anim_acc[ref] : nullptr);
+            if (acc == nullptr) {
+                n_unknown++;
+                continue;
+            }
+
+            XPLMSetDataf(obj_x_dr, obj.x);
+            XPLMSetDataf(obj_y_dr, obj.y);
+            XPLMSetDataf(obj_z_dr, obj.z);
+            XPLMSetDataf(obj_psi_dr, obj.psi);
+
+            auto t0 = std::chrono::steady_clock::now();
+            float res = acc((void *)ref);
+            auto t1 = std::chrono::steady_clock::now();
+
+            AccStat& s = stat[kind];
+            s.calls++;
+            s.ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            if (memcmp(&res, &val, sizeof(res))) {
+                if (mismatches++ < (unsigned long long)max_shown)
+                    fprintf(stderr, "mismatch %s(0x%llx) at t: %0.3f, obj: %0.3f, %0.3f, %0.3f, %0.1f: "
+                            "recorded %0.9g, replayed %0.9g\n", acc_name[kind], (unsigned long long)ref,
+                            xps_time(), obj.x, obj.y, obj.z, obj.psi, val, res);
+                s.mismatches++;
+            }
+            continue;
+        }
+
+        bool ok = true;
+        switch (tag) {
+            case kRecFrame: {
+                RecFrame f;
+                if ((ok = rd.get(f))) {
+                    set_frame(f);
+                    n_frames++;
+                }
+                break;
+            }
+
+            case kRecLoop: {
+                RecLoop l;
+                if ((ok = rd.get(l))) {
+                    set_loop_state(l);
+                    xps_run_loops();
+                    n_loops++;
+                    n_mp_loops += l.mp_active;
+                }
+                break;
+            }
+
+            case kRecEvent: {
+                RecEvent e;
+                if (!(ok = rd.get(e)))
+                    break;
+
+                n_events++;
+                xps_set_time(e.t);
+                switch (e.kind) {
+                    case kRecEvActivate:
+                        xps_command("openSAM/activate");
+                        break;
+                    case kRecEvAnimMenu:
+                        anim_menu_cb(nullptr, (void *)(uint64_t)e.arg);
+                        break;
+                    case kRecEvToggleMp:
+                        break;      // traffic is not recorded
+                    case kRecEvPlaneLoaded:
+                        xps_message(XPLM_MSG_PLANE_LOADED);
+                        break;
+                    case kRecEvLiveryLoaded:
+                        xps_message(XPLM_MSG_LIVERY_LOADED);
+                        break;
+                    case kRecEvAirportLoaded:
+                        xps_message(e.arg);
+                        break;
+                }
+                break;
+            }
+
+            case kRecPlane: {
+                RecPlane p;
+                if ((ok = rd.get(p)))
+                    set_plane(p);
+                break;
+            }
+
+            case kRecW2L:
+            case kRecL2W: {
+                RecXform x;
+                if ((ok = rd.get(x))) {
+                    auto& m = (tag == kRecW2L) ? w2l : l2w;
+                    m[{x.in[0], x.in[1], x.in[2]}] = {x.out[0], x.out[1], x.out[2]};
+                }
+                break;
+            }
+
+            case kRecProbe: {
+                RecProbe p;
+                if ((ok = rd.get(p)))
+                    probes[{p.x, p.y, p.z}] = p;
+                break;
+            }
+
+            default:
+                fprintf(stderr, "invalid record tag 0x%02x at offset %ld\n", tag,
+                        (long)(rd.p - 1 - trace.data()));
+                return 2;
+        }
+
+        if (!ok) {
+            truncated = true;
+            break;
+        }
+    }
+
+    xps_plugin_stop();
+
+    printf("{\"benchmark\": \"replay\", \"recorded_version\": \"%s\", \"version\": \"%s\",\n",
+           h.version, VERSION);
+    printf(" \"frames\": %llu, \"flight_loops\": %llu, \"mp_flight_loops\": %llu, \"events\": %llu,\n",
+           n_frames, n_loops, n_mp_loops, n_events);
+    printf(" \"xform_misses\": %llu, \"unknown_accessors\": %llu, \"truncated\": %s,\n",
+           xform_misses, n_unknown, truncated ? "true" : "false");
+    printf(" \"accessors\": {");
+    for (int k = 0; k < kRecAccNum; k++) {
+        const AccStat& s = stat[k];
+        printf("%s\n  \"%s\": {\"calls\": %llu, \"mismatches\": %llu, \"ns_per_call\": %0.1f}",
+               k ? "," : "", acc_name[k], s.calls, s.mismatches, s.calls ? s.ns / s.calls : 0.0);
+    }
+    printf("\n },\n \"identical\": %s\n}\n", mismatches == 0 ? "true" : "false");
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <filesystem>
+#include <algorithm>
+#include <random>
+
+#include "synth_world.h"
+
+namespace fs = std::filesystem;
+
+static constexpr double kM_per_deg = 111120.0;
+static constexpr int kSceneriesPerRow = 32;
+static constexpr double kRowSpacing = 150.0;
+static constexpr double kStandSpacing = 50.0;
+
+// in the frame of an A320 on the stand
+static constexpr float kA320DoorZ = -11.89f;
+static constexpr double kDockJwX = -26.0, kDockJwZ = -11.0;
+
+// local meters (x east, z south) relative to the scenery center -> world
+static SynthObj
+to_world(const SynthScenery& sc, double x, double z, float psi)
+{
+    SynthObj o;
+    o.lat = sc.lat - z / kM_per_deg;
+    o.lon = sc.lon + x / (kM_per_deg * cos(sc.lat * M_PI / 180.0));
+    o.elevation = 0.0f;
+    o.psi = psi;
+    return o;
+}
+
+SynthWorld
+synth_world_generate(const SynthWorldCfg& cfg)
+{
+    SynthWorld w;
+    w.cfg = cfg;
+    w.cfg.n_stands = std::max({cfg.n_stands, cfg.n_jetways, cfg.n_dgs});
+
+    for (int k = 0; k < cfg.n_anims; k++)
+        w.anim_drefs.push_back("sam/synth/anim_" + std::to_string(k));
+
+    for (int a = 0; a < cfg.n_auto; a++)
+        w.auto_drefs.push_back("sam/synth/auto_" + std::to_string(a));
+
+    for (int j = 0; j < cfg.n_sceneries; j++) {
+        SynthScenery sc;
+        char name[20];
+        snprintf(name, sizeof(name), "SYN%04d", j);
+        sc.name = name;
+        sc.lat = cfg.lat0 + (j / kSceneriesPerRow) * cfg.spacing;
+        sc.lon = cfg.lon0 + (j % kSceneriesPerRow) * cfg.spacing;
+
+        // stands facing north in rows, jetway to the left, DGS 25 m ahead
+        const int spr = std::max(cfg.stands_per_row, 1);
+        for (int i = 0; i < w.cfg.n_stands; i++) {
+            double x = (i % spr) * kStandSpacing - (spr - 1) * kStandSpacing / 2;
+            double z = (i / spr) * kRowSpacing;
+            sc.stands.push_back(to_world(sc, x, z, 0.0f));
+
+            if (i < cfg.n_jetways) {
+                if (cfg.dock_jws)
+                    sc.jetways.push_back(to_world(sc, x + kDockJwX, z + kDockJwZ, 90.0f));
+                else
+                    sc.jetways.push_back(to_world(sc, x - 20.0, z - 15.0, (float)((i * 37) % 360)));
+            }
+
+            if (i < cfg.n_dgs)
+                sc.dgs.push_back(to_world(sc, x, z - 25.0, 0.0f));
+        }
+
+        for (int k = 0; k < cfg.n_anims; k++)
+            sc.anims.push_back(to_world(sc, k * 30.0 - 500.0, -200.0, (float)((k * 53) % 360)));
+
+        w.sceneries.push_back(std::move(sc));
+    }
+
+    return w;
+}
+
+static bool
+write_library(const SynthWorld& w, const fs::path& dir)
+{
+    fs::create_directories(dir);
+    FILE *f = fopen((dir / "sam.xml").string().c_str(), "w");
+    if (f == nullptr)
+        return false;
+
+    fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<scenery name=\"openSAM_Library\">\n <datarefs>\n", f);
+    for (auto& d : w.anim_drefs)
+        fprintf(f, "  <dataref name=\"%s\">\n"
+                   "   <animation t=\"0\" v=\"0\"/>\n   <animation t=\"5\" v=\"0.5\"/>\n"
+                   "   <animation t=\"10\" v=\"1\"/>\n  </dataref>\n", d.c_str());
+
+    for (unsigned a = 0; a < w.auto_drefs.size(); a++)
+        fprintf(f, "  <dataref name=\"%s\" autoplay=\"true\" randomize_phase=\"%s\">\n"
+                   "   <animation t=\"0\" v=\"0\"/>\n   <animation t=\"2\" v=\"1\"/>\n"
+                   "   <animation t=\"4\" v=\"0\"/>\n  </dataref>\n",
+                w.auto_drefs[a].c_str(), (a & 1) ? "false" : "true");
+
+    fputs(" </datarefs>\n</scenery>\n", f);
+    return fclose(f) == 0;
+}
+
+static bool
+write_scenery(const SynthWorld& w, const SynthScenery& sc, const fs::path& dir)
+{
+    fs::create_directories(dir / "Earth nav data");
+
+    FILE *f = fopen((dir / "sam.xml").string().c_str(), "w");
+    if (f == nullptr)
+        return false;
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<scenery name=\"%s\">\n <jetways>\n",
+            sc.name.c_str());
+    for (unsigned i = 0; i < sc.jetways.size(); i++) {
+        const SynthObj& o = sc.jetways[i];
+        fprintf(f, "  <jetway name=\"J%u\" latitude=\"%0.8f\" longitude=\"%0.8f\" heading=\"%0.1f\""
+                   " height=\"4.5\" wheelPos=\"12\" cabinPos=\"16\" cabinLength=\"3\""
+                   " wheelDiameter=\"1\" wheelDistance=\"2.5\" minRot1=\"-90\" maxRot1=\"90\""
+                   " minRot2=\"-90\" maxRot2=\"90\" minRot3=\"-6\" maxRot3=\"6\""
+                   " minExtent=\"0\" maxExtent=\"18\" minWheels=\"-5\" maxWheels=\"5\""
+                   " initialRot1=\"0\" initialRot2=\"-30\" initialRot3=\"0\" initialExtent=\"0\"/>\n",
+                i + 1, o.lat, o.lon, o.psi);
+    }
+    fputs(" </jetways>\n <objects>\n", f);
+
+    for (unsigned k = 0; k < sc.anims.size(); k++) {
+        const SynthObj& o = sc.anims[k];
+        fprintf(f, "  <instance id=\"obj%u\" latitude=\"%0.8f\" longitude=\"%0.8f\""
+                   " elevation=\"0\" heading=\"%0.1f\"/>\n", k, o.lat, o.lon, o.psi);
+    }
+    fputs(" </objects>\n <gui>\n", f);
+
+    for (unsigned k = 0; k < sc.anims.size(); k++)
+        fprintf(f, "  <checkbox label=\"A%u\" title=\"Hangar door %u\" instance=\"obj%u\" dataref=\"%s\"/>\n",
+                k, k, k, w.anim_drefs[k].c_str());
+    fputs(" </gui>\n</scenery>\n", f);
+    if (fclose(f) != 0)
+        return false;
+
+    f = fopen((dir / "Earth nav data" / "apt.dat").string().c_str(), "w");
+    if (f == nullptr)
+        return false;
+
+    fprintf(f, "I\n1100 Generated by openSAM's synth_world\n\n1 0 0 0 %s Synthetic airport\n",
+            sc.name.c_str());
+    for (unsigned i = 0; i < sc.stands.size(); i++) {
+        const SynthObj& o = sc.stands[i];
+        fprintf(f, "1300 %0.8f %0.8f %0.2f gate jets|heavies S%u\n", o.lat, o.lon, o.psi, i + 1);
+    }
+
+    // taxiway nodes to get realistic file sizes
+    for (int i = 0; i < w.cfg.apt_padding; i++)
+        fprintf(f, "111 %0.8f %0.8f\n", sc.lat + i * 1.0E-6, sc.lon);
+
+    fputs("99\n", f);
+    return fclose(f) == 0;
+}
+
+bool
+synth_world_write(const SynthWorld& w, const std::string& xp_dir, const std::string& pkg_dir)
+{
+    fs::path root(xp_dir);
+    fs::path cs = root / "Custom Scenery";
+    std::error_code ec;
+
+    fs::create_directories(cs, ec);
+    if (!pkg_dir.empty()) {
+        fs::create_directories(root / "Resources" / "plugins", ec);
+        fs::create_directories(root / "Output" / "preferences", ec);
+        fs::path plugin_dir = root / "Resources" / "plugins" / "openSAM";
+        fs::remove(plugin_dir, ec);
+        fs::create_directory_symlink(fs::absolute(pkg_dir), plugin_dir, ec);
+        if (ec) {
+            fprintf(stderr, "can't link '%s': %s\n", pkg_dir.c_str(), ec.message().c_str());
+            return false;
+        }
+    }
+
+    if (!write_library(w, cs / "openSAM_Library"))
+        return false;
+
+    FILE *f = fopen((cs / "scenery_packs.ini").string().c_str(), "w");
+    if (f == nullptr)
+        return false;
+
+    fputs("I\n1000 Version\nSCENERY\n\n", f);
+    for (auto& sc : w.sceneries) {
+        if (!write_scenery(w, sc, cs / sc.name)) {
+            fclose(f);
+            return false;
+        }
+        fprintf(f, "SCENERY_PACK Custom Scenery/%s/\n", sc.name.c_str());
+    }
+    fputs("SCENERY_PACK *GLOBAL_AIRPORTS*\nSCENERY_PACK Custom Scenery/openSAM_Library/\n", f);
+    return fclose(f) == 0;
+}
+
+float
+synth_stop_z(float door_z)
+{
+    return kA320DoorZ - door_z;
+}
+
+std::string
+synth_mkdtemp(const char *prefix)
+{
+    std::error_code ec;
+    fs::path tmp = fs::temp_directory_path(ec);
+    std::random_device rd;
+
+    for (int i = 0; i < 100; i++) {
+        char sfx[20];
+        snprintf(sfx, sizeof(sfx), "_%08x", rd());
+        fs::path dir = tmp / (std::string(prefix) + sfx);
+        if (fs::create_directory(dir, ec))
+            return dir.generic_string() + "/";
+    }
+
+    return "";
+}
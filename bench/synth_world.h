@@ -0,0 +1,87 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _SYNTH_WORLD_H_
+#define _SYNTH_WORLD_H_
+
+//
+// Generator for synthetic SAM worlds: a Custom Scenery tree with
+// n_sceneries packs, each one an airport with sam.xml and apt.dat.
+//
+// Stands are laid out in rows, each stand has its jetway to the left,
+// the first n_dgs stands get a DGS in front, n_anims animated objects
+// with a checkbox each. The library provides n_auto autoplay datarefs.
+//
+// By default the jetways just stand around. With dock_jws they are placed
+// so that an A320 with its CG on the stand can dock, larger types must
+// stop with door 1 at the same spot (see synth_stop_z()).
+//
+
+#include <string>
+#include <vector>
+
+struct SynthWorldCfg {
+    int n_sceneries{10};
+    int n_jetways{20};      // per scenery
+    int n_stands{30};       // per scenery, at least n_jetways and n_dgs
+    int n_anims{5};         // per scenery
+    int n_dgs{20};          // per scenery
+    int n_auto{4};          // autoplay datarefs in the library
+    double lat0{50.0}, lon0{8.0};   // first airport
+    double spacing{0.2};    // ° between airports, 0 -> all at the same place
+    int apt_padding{0};     // number of filler lines in apt.dat
+    int stands_per_row{20};
+    bool dock_jws{false};   // jetways in docking position, see above
+};
+
+// an object as it is drawn by X-Plane
+struct SynthObj {
+    float lat, lon, elevation, psi;
+};
+
+struct SynthScenery {
+    std::string name;
+    double lat, lon;            // center
+    std::vector<SynthObj> jetways, stands, dgs, anims;
+};
+
+struct SynthWorld {
+    SynthWorldCfg cfg;
+    std::vector<SynthScenery> sceneries;
+    std::vector<std::string> anim_drefs;    // one per anim object index
+    std::vector<std::string> auto_drefs;
+};
+
+extern SynthWorld synth_world_generate(const SynthWorldCfg& cfg);
+
+// write scenery_packs.ini, openSAM_Library and all packs below xp_dir,
+// link Resources/plugins/openSAM to the package directory pkg_dir if not empty
+extern bool synth_world_write(const SynthWorld& world, const std::string& xp_dir,
+                              const std::string& pkg_dir);
+
+// z offset (m, south) of the CG of a plane against its stand so that door 1
+// with door_z (m, +z to the tail) stops where an A320's door does
+extern float synth_stop_z(float door_z);
+
+// a fresh directory in the temp directory, with trailing '/'
+extern std::string synth_mkdtemp(const char *prefix);
+
+#endif
@@ -0,0 +1,321 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "XPLMDataAccess.h"
+#include "XPLMGraphics.h"
+
+#include "LTAPI.h"
+
+#include "xplm_standin.h"
+#include "traffic_standin.h"
+
+static constexpr double kM_per_deg = 111120.0;
+static constexpr double kD2R = M_PI / 180.0;
+static constexpr double kTaxiDist = 150.0;     // (m) south of the stand
+
+// TGXP's flight phases and traffic types as used by openSAM
+enum { kTgxpTaxiIn = 3, kTgxpParked = 5, kTgxpStartup = 6, kTgxpTaxiOut = 7 };
+enum { kTgxpAirline = 0 };
+
+static const std::vector<TsAircraft> *traffic;
+static bool has_provider[kTsNum];
+
+// xPilot
+static int tcas_slots;
+static std::vector<int> slot_of;       // per aircraft, 0 = none
+static std::vector<int> free_slots;
+static int n_dropped;
+
+// LiveTraffic
+static std::vector<LTAPIAircraft::LTAPIBulkData> lt_quick;
+static std::vector<LTAPIAircraft::LTAPIBulkInfoTexts> lt_expensive;
+
+const char *
+ts_provider_name(TsProvider p)
+{
+    static const char *names[kTsNum] = {"tgxp", "xpilot", "lt"};
+    return names[p];
+}
+
+TsPhase
+ts_phase(const TsAircraft& ac, float t)
+{
+    if (t < ac.t_arrive)
+        return kTsAbsent;
+    if (t < ac.t_park)
+        return kTsTaxiIn;
+    if (t < ac.t_startup)
+        return kTsParked;
+    if (t < ac.t_depart)
+        return kTsStartup;
+    if (t < ac.t_gone)
+        return kTsTaxiOut;
+    return kTsGone;
+}
+
+// position of the CG, taxiing is straight north in, pushback straight south
+static void
+position(const TsAircraft& ac, TsPhase phase, float t, double& lat, double& lon)
+{
+    double dz = 0.0;
+    if (phase == kTsTaxiIn)
+        dz = kTaxiDist * (ac.t_park - t) / (ac.t_park - ac.t_arrive);
+    else if (phase == kTsTaxiOut)
+        dz = kTaxiDist * (t - ac.t_depart) / (ac.t_gone - ac.t_depart);
+
+    lat = ac.lat - dz / kM_per_deg;
+    lon = ac.lon;
+}
+
+// read function of LTAPI's bulk datarefs: nullptr returns the struct size,
+// otherwise ofs and n are bytes into the array of structs
+template<typename T>
+static int
+lt_bulk(void *ref, void *out, int ofs, int n)
+{
+    const std::vector<T>& v = *static_cast<const std::vector<T> *>(ref);
+    if (out == nullptr)
+        return sizeof(T);
+
+    int first = ofs / (int)sizeof(T);
+    int cnt = std::min(n / (int)sizeof(T), (int)v.size() - first);
+    if (cnt <= 0)
+        return 0;
+
+    memcpy(out, v.data() + first, cnt * sizeof(T));
+    return cnt * sizeof(T);
+}
+
+void
+ts_init(const std::vector<TsAircraft>& tr, int n_slots)
+{
+    traffic = &tr;
+    for (auto& ac : tr)
+        has_provider[ac.provider] = true;
+
+    if (has_provider[kTsXpilot]) {
+        tcas_slots = n_slots;
+        slot_of.assign(tr.size(), 0);
+        free_slots.clear();
+        for (int s = tcas_slots - 1; s >= 1; s--)
+            free_slots.push_back(s);
+        n_dropped = 0;
+        xps_set("xpilot/login/status", 1);
+    }
+
+    if (has_provider[kTsLt]) {
+        xps_add_plugin("TwinFan.plugin.LiveTraffic");
+        xps_set("livetraffic/cfg/aircrafts_displayed", 1);
+        xps_set("livetraffic/ac/num", 0);
+        XPLMRegisterDataAccessor("livetraffic/bulk/quick", xplmType_Data, 0,
+                                 nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                 nullptr, nullptr, nullptr, nullptr,
+                                 lt_bulk<LTAPIAircraft::LTAPIBulkData>, nullptr, &lt_quick, nullptr);
+        XPLMRegisterDataAccessor("livetraffic/bulk/expensive", xplmType_Data, 0,
+                                 nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                 nullptr, nullptr, nullptr, nullptr,
+                                 lt_bulk<LTAPIAircraft::LTAPIBulkInfoTexts>, nullptr, &lt_expensive, nullptr);
+    }
+
+    ts_update(0.0f);
+}
+
+int
+ts_dropped()
+{
+    return n_dropped;
+}
+
+//============== TGXP ==================================================
+static void
+update_tgxp(float t)
+{
+    std::vector<int> phase, type;
+    std::vector<float> x, y, z, psi;
+    std::string code, tail;
+
+    for (auto& ac : *traffic) {
+        if (ac.provider != kTsTgxp)
+            continue;
+
+        TsPhase p = ts_phase(ac, t);
+        if (p == kTsAbsent || p == kTsGone)
+            continue;
+
+        static const int tgxp_phase[] = {0, kTgxpTaxiIn, kTgxpParked, kTgxpStartup, kTgxpTaxiOut, 0};
+        // TGXP's reference point is 1 m ahead of the CG
+        double lat, lon, lx, ly, lz;
+        position(ac, p, t, lat, lon);
+        lat += cos(ac.psi * kD2R) / kM_per_deg;
+        lon += sin(ac.psi * kD2R) / (kM_per_deg * cos(lat * kD2R));
+        XPLMWorldToLocal(lat, lon, 0.0, &lx, &ly, &lz);
+
+        phase.push_back(tgxp_phase[p]);
+        type.push_back(kTgxpAirline);
+        x.push_back(lx); y.push_back(ly); z.push_back(lz);
+        psi.push_back(ac.psi);
+
+        // NUL separated lists
+        code.append(ac.tgxp_code).push_back('\0');
+        tail.append(ac.flight_id).push_back('\0');
+    }
+
+    // xps_set_str() terminates with another NUL
+    if (!code.empty()) {
+        code.pop_back();
+        tail.pop_back();
+    }
+
+    xps_set_vi("trafficglobal/ai/flight_phase", phase);
+    xps_set_vi("trafficglobal/ai/ai_type", type);
+    xps_set_vf("trafficglobal/ai/position_x", x);
+    xps_set_vf("trafficglobal/ai/position_y", y);
+    xps_set_vf("trafficglobal/ai/position_z", z);
+    xps_set_vf("trafficglobal/ai/position_heading", psi);
+    xps_set_str("trafficglobal/ai/aircraft_code", code);
+    xps_set_str("trafficglobal/ai/tail_number", tail);
+}
+
+//============== xPilot ================================================
+static void
+update_xpilot(float t)
+{
+    std::vector<int> modeS_id(tcas_slots), on_ground(tcas_slots), lights(tcas_slots);
+    std::vector<float> x(tcas_slots), y(tcas_slots), z(tcas_slots), psi(tcas_slots), throttle(tcas_slots);
+    std::string icao_type(tcas_slots * 8, '\0'), flight_id(tcas_slots * 8, '\0');
+
+    for (unsigned i = 0; i < traffic->size(); i++) {
+        const TsAircraft& ac = (*traffic)[i];
+        if (ac.provider != kTsXpilot)
+            continue;
+
+        TsPhase p = ts_phase(ac, t);
+        int& slot = slot_of[i];
+
+        if (p == kTsAbsent || p == kTsGone) {
+            if (slot > 0) {
+                free_slots.push_back(slot);
+                slot = 0;
+            }
+            continue;
+        }
+
+        if (slot == 0) {
+            if (free_slots.empty()) {
+                slot = -1;      // for the whole lifetime
+                n_dropped++;
+            } else {
+                slot = free_slots.back();
+                free_slots.pop_back();
+            }
+        }
+
+        if (slot < 0)
+            continue;
+
+        double lat, lon, lx, ly, lz;
+        position(ac, p, t, lat, lon);
+        XPLMWorldToLocal(lat, lon, 0.0, &lx, &ly, &lz);
+
+        modeS_id[slot] = 0x400000 + i;
+        on_ground[slot] = 1;
+        lights[slot] = (p != kTsParked);       // bit 0 = beacon
+        x[slot] = lx; y[slot] = ly; z[slot] = lz;
+        psi[slot] = ac.psi;
+        throttle[slot] = (p == kTsTaxiIn || p == kTsTaxiOut) ? 0.3f : 0.0f;
+        ac.icao.copy(&icao_type[slot * 8], 7);
+        ac.flight_id.copy(&flight_id[slot * 8], 7);
+    }
+
+    xps_set_vi("sim/cockpit2/tcas/targets/modeS_id", modeS_id);
+    xps_set_vi("sim/cockpit2/tcas/targets/position/weight_on_wheels", on_ground);
+    xps_set_vi("sim/cockpit2/tcas/targets/position/lights", lights);
+    xps_set_vf("sim/cockpit2/tcas/targets/position/x", x);
+    xps_set_vf("sim/cockpit2/tcas/targets/position/y", y);
+    xps_set_vf("sim/cockpit2/tcas/targets/position/z", z);
+    xps_set_vf("sim/cockpit2/tcas/targets/position/psi", psi);
+    xps_set_vf("sim/cockpit2/tcas/targets/position/throttle", throttle);
+
+    // fixed size, xps_set_str() appends a NUL
+    icao_type.pop_back();
+    flight_id.pop_back();
+    xps_set_str("sim/cockpit2/tcas/targets/icao_type", icao_type);
+    xps_set_str("sim/cockpit2/tcas/targets/flight_id", flight_id);
+}
+
+//============== LiveTraffic ===========================================
+static void
+update_lt(float t)
+{
+    lt_quick.clear();
+    lt_expensive.clear();
+
+    for (unsigned i = 0; i < traffic->size(); i++) {
+        const TsAircraft& ac = (*traffic)[i];
+        if (ac.provider != kTsLt)
+            continue;
+
+        TsPhase p = ts_phase(ac, t);
+        if (p == kTsAbsent || p == kTsGone)
+            continue;
+
+        LTAPIAircraft::LTAPIBulkData q;
+        q.keyNum = 0xA00000 + i;
+        position(ac, p, t, q.lat, q.lon);
+        q.alt_ft = 0.0;
+        q.lat_f = q.lat; q.lon_f = q.lon; q.alt_ft_f = 0.0f;
+        q.heading = q.track = ac.psi;
+        q.speed_kt = (p == kTsTaxiIn || p == kTsTaxiOut) ? 10.0f : 0.0f;
+        q.gear = 1.0f;
+        q.bits.phase = (p == kTsParked || p == kTsStartup) ? LTAPIAircraft::FPH_PARKED : LTAPIAircraft::FPH_TAXI;
+        q.bits.onGnd = true;
+        q.bits.bcn = (p != kTsParked);
+        q.bits.nav = true;
+        lt_quick.push_back(q);
+
+        LTAPIAircraft::LTAPIBulkInfoTexts e;
+        e.keyNum = q.keyNum;
+        strncpy(e.registration, ac.flight_id.c_str(), sizeof(e.registration) - 1);
+        strncpy(e.modelIcao, ac.icao.c_str(), sizeof(e.modelIcao) - 1);
+        strncpy(e.callSign, ac.flight_id.c_str(), sizeof(e.callSign) - 1);
+        lt_expensive.push_back(e);
+    }
+
+    xps_set("livetraffic/ac/num", lt_quick.size());
+}
+
+void
+ts_update(float t)
+{
+    if (has_provider[kTsTgxp])
+        update_tgxp(t);
+    if (has_provider[kTsXpilot])
+        update_xpilot(t);
+    if (has_provider[kTsLt])
+        update_lt(t);
+}
@@ -0,0 +1,74 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _TRAFFIC_STANDIN_H_
+#define _TRAFFIC_STANDIN_H_
+
+//
+// Stand-ins for the traffic providers openSAM's MP adapters talk to,
+// built on the XPLM stand-in:
+//
+//  - TGXP: the trafficglobal/ai/* arrays
+//  - xPilot: xpilot/login/status and the sim/cockpit2/tcas/targets/* arrays
+//    with a fixed number of slots, slot 0 is the user's plane
+//  - LiveTraffic: the plugin signature and the livetraffic/* datarefs
+//    with the bulk/quick and bulk/expensive accessors of LTAPI
+//
+// Each aircraft follows a script: it taxies in from the south, parks on
+// its stand, starts up (beacon on) and pushes back.
+// ts_update() republishes all feeds for the current time.
+//
+
+#include <string>
+#include <vector>
+
+enum TsProvider { kTsTgxp, kTsXpilot, kTsLt, kTsNum };
+
+enum TsPhase { kTsAbsent, kTsTaxiIn, kTsParked, kTsStartup, kTsTaxiOut, kTsGone };
+
+struct TsAircraft {
+    TsProvider provider;
+    std::string flight_id;      // at most 7 chars
+    std::string icao;           // e.g. "A320", for xPilot and LT
+    std::string tgxp_code;      // e.g. "320_SYNTH", for TGXP
+    double lat, lon;            // CG when parked
+    float psi;
+
+    // script: absent < t_arrive <= taxi in < t_park <= parked < t_startup <= startup
+    //         < t_depart <= taxi out < t_gone <= gone
+    float t_arrive, t_park, t_startup, t_depart, t_gone;
+};
+
+extern TsPhase ts_phase(const TsAircraft& ac, float t);
+
+// register the providers that have aircraft in traffic, keep a reference to traffic
+extern void ts_init(const std::vector<TsAircraft>& traffic, int tcas_slots = 64);
+
+// republish all feeds for time t
+extern void ts_update(float t);
+
+// # of xPilot aircraft that did not get a TCAS slot so far
+extern int ts_dropped();
+
+// name as used on the command line
+extern const char *ts_provider_name(TsProvider p);
+
+#endif
@@ -0,0 +1,1143 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "XPLMDefs.h"
+#include "XPLMDataAccess.h"
+#include "XPLMUtilities.h"
+#include "XPLMPlugin.h"
+#include "XPLMPlanes.h"
+#include "XPLMProcessing.h"
+#include "XPLMGraphics.h"
+#include "XPLMDisplay.h"
+#include "XPLMMenus.h"
+#include "XPLMNavigation.h"
+#include "XPLMScenery.h"
+#include "XPLMInstance.h"
+#include "XPLMSound.h"
+#include "XPWidgets.h"
+#include "XPStandardWidgets.h"
+
+#include "xplm_standin.h"
+
+static constexpr double kM_per_deg = 111120.0;  // same as openSAM's LAT_2_M
+static constexpr double kD2R = M_PI / 180.0;
+
+static bool quiet;
+static std::string xp_dir{"./"};
+static std::string acf_path;
+
+static double lat_ref, lon_ref, terrain_elevation;
+static double now;                  // simulated time
+static int frame_cnt;
+
+//============== datarefs ==============================================
+struct Dref {
+    std::string name;
+    XPLMDataTypeID types{0};
+    bool is_acc{false};     // registered by XPLMRegisterDataAccessor
+
+    XPLMGetDatai_f ri{}; XPLMSetDatai_f wi{};
+    XPLMGetDataf_f rf{}; XPLMSetDataf_f wf{};
+    XPLMGetDatad_f rd{}; XPLMSetDatad_f wd{};
+    XPLMGetDatavi_f rvi{}; XPLMSetDatavi_f wvi{};
+    XPLMGetDatavf_f rvf{}; XPLMSetDatavf_f wvf{};
+    XPLMGetDatab_f rb{}; XPLMSetDatab_f wb{};
+    void *rd_ref{}, *wr_ref{};
+
+    // value store for "sim" and shared datarefs
+    double val{0.0};
+    std::vector<int> vi;
+    std::vector<float> vf;
+    std::vector<uint8_t> b;
+
+    std::vector<std::pair<XPLMDataChanged_f, void *>> notify;    // shared data
+};
+
+// X-Plane is up before any plugin so datarefs must be available during
+// static initialization of the plugin (e.g. MyPlane's constructor)
+static std::unordered_map<std::string, std::unique_ptr<Dref>>&
+dref_map()
+{
+    static std::unordered_map<std::string, std::unique_ptr<Dref>> drefs;
+    return drefs;
+}
+
+static Dref *
+get_dref(const char *name, XPLMDataTypeID types)
+{
+    auto& d = dref_map()[name];
+    if (d == nullptr) {
+        d = std::make_unique<Dref>();
+        d->name = name;
+        d->types = types;
+    }
+    return d.get();
+}
+
+static void
+notify(Dref *d)
+{
+    for (auto& n : d->notify)
+        if (n.first)
+            n.first(n.second);
+}
+
+template<typename T>
+static int
+get_array(const std::vector<T>& v, T *out, int ofs, int n)
+{
+    int size = v.size();
+    if (out == nullptr)
+        return size;
+
+    if (ofs >= size)
+        return 0;
+
+    n = std::min(n, size - ofs);
+    std::copy(v.begin() + ofs, v.begin() + ofs + n, out);
+    return n;
+}
+
+template<typename T>
+static void
+set_array(std::vector<T>& v, const T *in, int ofs, int n)
+{
+    if ((int)v.size() < ofs + n)
+        v.resize(ofs + n);
+    std::copy(in, in + n, v.begin() + ofs);
+}
+
+XPLMDataRef
+XPLMFindDataRef(const char *name)
+{
+    auto& drefs = dref_map();
+    auto it = drefs.find(name);
+    if (it != drefs.end())
+        return it->second.get();
+
+    // everything of X-Plane itself "exists"
+    if (strncmp(name, "sim/", 4) == 0)
+        return get_dref(name, xplmType_Int | xplmType_Float | xplmType_Double);
+
+    return nullptr;
+}
+
+XPLMDataTypeID
+XPLMGetDataRefTypes(XPLMDataRef ref)
+{
+    return ref ? ((Dref *)ref)->types : xplmType_Unknown;
+}
+
+int
+XPLMGetDatai(XPLMDataRef ref)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0;
+    if (d->is_acc)
+        return d->ri ? d->ri(d->rd_ref) : 0;
+    return d->val;
+}
+
+void
+XPLMSetDatai(XPLMDataRef ref, int val)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wi)
+            d->wi(d->wr_ref, val);
+        return;
+    }
+    d->val = val;
+    notify(d);
+}
+
+float
+XPLMGetDataf(XPLMDataRef ref)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0.0f;
+    if (d->is_acc)
+        return d->rf ? d->rf(d->rd_ref) : 0.0f;
+    return d->val;
+}
+
+void
+XPLMSetDataf(XPLMDataRef ref, float val)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wf)
+            d->wf(d->wr_ref, val);
+        return;
+    }
+    d->val = val;
+    notify(d);
+}
+
+double
+XPLMGetDatad(XPLMDataRef ref)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0.0;
+    if (d->is_acc)
+        return d->rd ? d->rd(d->rd_ref) : 0.0;
+    return d->val;
+}
+
+void
+XPLMSetDatad(XPLMDataRef ref, double val)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wd)
+            d->wd(d->wr_ref, val);
+        return;
+    }
+    d->val = val;
+    notify(d);
+}
+
+int
+XPLMGetDatavi(XPLMDataRef ref, int *values, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0;
+    if (d->is_acc)
+        return d->rvi ? d->rvi(d->rd_ref, values, ofs, n) : 0;
+    return get_array(d->vi, values, ofs, n);
+}
+
+void
+XPLMSetDatavi(XPLMDataRef ref, int *values, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wvi)
+            d->wvi(d->wr_ref, values, ofs, n);
+        return;
+    }
+    set_array(d->vi, values, ofs, n);
+    notify(d);
+}
+
+int
+XPLMGetDatavf(XPLMDataRef ref, float *values, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0;
+    if (d->is_acc)
+        return d->rvf ? d->rvf(d->rd_ref, values, ofs, n) : 0;
+    return get_array(d->vf, values, ofs, n);
+}
+
+void
+XPLMSetDatavf(XPLMDataRef ref, float *values, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wvf)
+            d->wvf(d->wr_ref, values, ofs, n);
+        return;
+    }
+    set_array(d->vf, values, ofs, n);
+    notify(d);
+}
+
+int
+XPLMGetDatab(XPLMDataRef ref, void *value, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return 0;
+    if (d->is_acc)
+        return d->rb ? d->rb(d->rd_ref, value, ofs, n) : 0;
+    return get_array(d->b, (uint8_t *)value, ofs, n);
+}
+
+void
+XPLMSetDatab(XPLMDataRef ref, void *value, int ofs, int n)
+{
+    Dref *d = (Dref *)ref;
+    if (d == nullptr)
+        return;
+    if (d->is_acc) {
+        if (d->wb)
+            d->wb(d->wr_ref, value, ofs, n);
+        return;
+    }
+    set_array(d->b, (const uint8_t *)value, ofs, n);
+    notify(d);
+}
+
+XPLMDataRef
+XPLMRegisterDataAccessor(const char *name, XPLMDataTypeID type, int is_writable,
+                         XPLMGetDatai_f ri, XPLMSetDatai_f wi,
+                         XPLMGetDataf_f rf, XPLMSetDataf_f wf,
+                         XPLMGetDatad_f rd, XPLMSetDatad_f wd,
+                         XPLMGetDatavi_f rvi, XPLMSetDatavi_f wvi,
+                         XPLMGetDatavf_f rvf, XPLMSetDatavf_f wvf,
+                         XPLMGetDatab_f rb, XPLMSetDatab_f wb,
+                         void *rd_ref, void *wr_ref)
+{
+    Dref *d = get_dref(name, type);
+    d->types = type;
+    d->is_acc = true;
+    d->ri = ri; d->rf = rf; d->rd = rd; d->rvi = rvi; d->rvf = rvf; d->rb = rb;
+    if (is_writable) {
+        d->wi = wi; d->wf = wf; d->wd = wd; d->wvi = wvi; d->wvf = wvf; d->wb = wb;
+    }
+    d->rd_ref = rd_ref;
+    d->wr_ref = wr_ref;
+    return d;
+}
+
+void
+XPLMUnregisterDataAccessor(XPLMDataRef ref)
+{
+    Dref *d = (Dref *)ref;
+    if (d)
+        dref_map().erase(d->name);
+}
+
+int
+XPLMShareData(const char *name, XPLMDataTypeID type, XPLMDataChanged_f cb, void *ref)
+{
+    Dref *d = get_dref(name, type);
+    if (d->is_acc || d->types != type)
+        return 0;
+
+    d->notify.push_back({cb, ref});
+    return 1;
+}
+
+int
+XPLMUnshareData(const char *name, XPLMDataTypeID type, XPLMDataChanged_f cb, void *ref)
+{
+    auto& drefs = dref_map();
+    auto it = drefs.find(name);
+    if (it == drefs.end() || it->second->types != type)
+        return 0;
+
+    auto& n = it->second->notify;
+    auto i = std::find(n.begin(), n.end(), std::make_pair(cb, ref));
+    if (i == n.end())
+        return 0;
+
+    n.erase(i);
+    return 1;
+}
+
+XPLMDataRef
+xps_set(const char *name, double val)
+{
+    Dref *d = get_dref(name, xplmType_Int | xplmType_Float | xplmType_Double);
+    d->val = val;
+    notify(d);
+    return d;
+}
+
+XPLMDataRef
+xps_set_vf(const char *name, const std::vector<float>& val)
+{
+    Dref *d = get_dref(name, xplmType_FloatArray);
+    d->vf = val;
+    notify(d);
+    return d;
+}
+
+XPLMDataRef
+xps_set_vi(const char *name, const std::vector<int>& val)
+{
+    Dref *d = get_dref(name, xplmType_IntArray);
+    d->vi = val;
+    notify(d);
+    return d;
+}
+
+XPLMDataRef
+xps_set_str(const char *name, const std::string& val)
+{
+    Dref *d = get_dref(name, xplmType_Data);
+    d->b.assign(val.begin(), val.end());
+    d->b.push_back(0);
+    notify(d);
+    return d;
+}
+
+XPLMGetDataf_f
+xps_float_accessor(const char *name)
+{
+    auto& drefs = dref_map();
+    auto it = drefs.find(name);
+    if (it == drefs.end() || !it->second->is_acc)
+        return nullptr;
+    return it->second->rf;
+}
+
+int
+xps_n_datarefs()
+{
+    return dref_map().size();
+}
+
+//============== world =================================================
+static XpsXformHook xform_hook;
+
+void
+xps_set_xform_hook(const XpsXformHook& hook)
+{
+    xform_hook = hook;
+}
+
+void
+XPLMWorldToLocal(double lat, double lon, double alt, double *x, double *y, double *z)
+{
+    if (xform_hook.world_to_local && xform_hook.world_to_local(lat, lon, alt, x, y, z))
+        return;
+
+    double dlon = lon - lon_ref;
+    if (dlon > 180.0)
+        dlon -= 360.0;
+    else if (dlon < -180.0)
+        dlon += 360.0;
+
+    *x = dlon * kM_per_deg * cos(lat_ref * kD2R);
+    *y = alt;
+    *z = (lat_ref - lat) * kM_per_deg;
+}
+
+void
+XPLMLocalToWorld(double x, double y, double z, double *lat, double *lon, double *alt)
+{
+    if (xform_hook.local_to_world && xform_hook.local_to_world(x, y, z, lat, lon, alt))
+        return;
+
+    *lat = lat_ref - z / kM_per_deg;
+    *lon = lon_ref + x / (kM_per_deg * cos(lat_ref * kD2R));
+    if (*lon >= 180.0)
+        *lon -= 360.0;
+    else if (*lon < -180.0)
+        *lon += 360.0;
+    *alt = y;
+}
+
+void
+xps_set_ref(double lat, double lon)
+{
+    lat_ref = lat;
+    lon_ref = lon;
+    xps_set("sim/flightmodel/position/lat_ref", lat);
+    xps_set("sim/flightmodel/position/lon_ref", lon);
+}
+
+void
+xps_set_terrain(double elevation)
+{
+    terrain_elevation = elevation;
+}
+
+void
+xps_place_plane(double lat, double lon, float psi)
+{
+    double x, y, z;
+    XPLMWorldToLocal(lat, lon, terrain_elevation, &x, &y, &z);
+    xps_set("sim/flightmodel/position/latitude", lat);
+    xps_set("sim/flightmodel/position/longitude", lon);
+    xps_set("sim/flightmodel/position/elevation", terrain_elevation);
+    xps_set("sim/flightmodel/position/local_x", x);
+    xps_set("sim/flightmodel/position/local_y", y);
+    xps_set("sim/flightmodel/position/local_z", z);
+    xps_set("sim/flightmodel2/position/true_psi", psi);
+}
+
+XPLMProbeRef
+XPLMCreateProbe([[maybe_unused]] XPLMProbeType type)
+{
+    return new XPLMProbeInfo_t;
+}
+
+void
+XPLMDestroyProbe(XPLMProbeRef probe)
+{
+    delete (XPLMProbeInfo_t *)probe;
+}
+
+XPLMProbeResult
+XPLMProbeTerrainXYZ(XPLMProbeRef probe, float x, [[maybe_unused]] float y, float z,
+                    XPLMProbeInfo_t *info)
+{
+    if (probe == nullptr)
+        return xplm_ProbeError;
+
+    XPLMProbeResult res;
+    if (xform_hook.probe && xform_hook.probe(x, y, z, &res, info))
+        return res;
+
+    info->locationX = x;
+    info->locationY = terrain_elevation;
+    info->locationZ = z;
+    info->normalX = info->normalZ = 0.0f;
+    info->normalY = 1.0f;
+    info->velocityX = info->velocityY = info->velocityZ = 0.0f;
+    info->is_wet = 0;
+    return xplm_ProbeHitTerrain;
+}
+
+// objects and instances are never drawn, just kept track of
+struct Instance {
+    XPLMDrawInfo_t pos;
+    std::vector<float> data;
+};
+
+static int n_objects, n_instances;
+
+XPLMObjectRef
+XPLMLoadObject([[maybe_unused]] const char *path)
+{
+    return (XPLMObjectRef)(intptr_t)(++n_objects);
+}
+
+void
+XPLMUnloadObject([[maybe_unused]] XPLMObjectRef obj)
+{
+}
+
+XPLMInstanceRef
+XPLMCreateInstance(XPLMObjectRef obj, const char **datarefs)
+{
+    if (obj == nullptr)
+        return nullptr;
+
+    int n = 0;
+    while (datarefs && datarefs[n])
+        n++;
+
+    Instance *inst = new Instance();
+    inst->data.resize(n);
+    n_instances++;
+    return inst;
+}
+
+void
+XPLMDestroyInstance(XPLMInstanceRef ref)
+{
+    if (ref == nullptr)
+        return;
+    delete (Instance *)ref;
+    n_instances--;
+}
+
+void
+XPLMInstanceSetPosition(XPLMInstanceRef ref, const XPLMDrawInfo_t *pos, const float *data)
+{
+    Instance *inst = (Instance *)ref;
+    inst->pos = *pos;
+    if (data)
+        std::copy(data, data + inst->data.size(), inst->data.begin());
+}
+
+int
+xps_n_instances()
+{
+    return n_instances;
+}
+
+//============== navigation ============================================
+struct Airport {
+    std::string icao;
+    float lat, lon, elevation;
+};
+
+static std::vector<Airport> airports;
+
+void
+xps_add_airport(const char *icao, float lat, float lon, float elevation)
+{
+    airports.push_back({icao, lat, lon, elevation});
+}
+
+XPLMNavRef
+XPLMFindNavAid([[maybe_unused]] const char *name_frag, const char *id_frag, float *lat, float *lon,
+               [[maybe_unused]] int *freq, XPLMNavType type)
+{
+    if (type != xplm_Nav_Airport || airports.empty())
+        return XPLM_NAV_NOT_FOUND;
+
+    if (id_frag) {
+        for (unsigned i = 0; i < airports.size(); i++)
+            if (airports[i].icao.find(id_frag) != std::string::npos)
+                return i;
+        return XPLM_NAV_NOT_FOUND;
+    }
+
+    if (lat == nullptr || lon == nullptr)
+        return 0;
+
+    // nearest one
+    int best = 0;
+    float best_d = 1.0E10f;
+    for (unsigned i = 0; i < airports.size(); i++) {
+        float dlat = airports[i].lat - *lat;
+        float dlon = (airports[i].lon - *lon) * cosf(*lat * kD2R);
+        float d = dlat * dlat + dlon * dlon;
+        if (d < best_d) {
+            best_d = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void
+XPLMGetNavAidInfo(XPLMNavRef ref, XPLMNavType *type, float *lat, float *lon, float *height,
+                  int *freq, float *heading, char *id, char *name, char *reg)
+{
+    if (ref < 0 || ref >= (int)airports.size())
+        return;
+
+    const Airport& a = airports[ref];
+    if (type) *type = xplm_Nav_Airport;
+    if (lat) *lat = a.lat;
+    if (lon) *lon = a.lon;
+    if (height) *height = a.elevation;
+    if (freq) *freq = 0;
+    if (heading) *heading = 0.0f;
+    if (id) strcpy(id, a.icao.c_str());
+    if (name) strcpy(name, a.icao.c_str());
+    if (reg) *reg = 0;
+}
+
+//============== flight loops ==========================================
+struct FlightLoop {
+    XPLMFlightLoop_f cb;
+    void *ref;
+    double next_time;   // < 0 -> not scheduled
+    int next_frame;     // < 0 -> scheduled by time
+    double last_call;
+};
+
+static std::vector<FlightLoop> flight_loops;
+
+static void
+schedule(FlightLoop& fl, float interval, double base)
+{
+    fl.next_time = -1.0;
+    fl.next_frame = -1;
+    if (interval > 0.0f)
+        fl.next_time = base + interval;
+    else if (interval < 0.0f)
+        fl.next_frame = frame_cnt + (int)(-interval);
+}
+
+void
+XPLMRegisterFlightLoopCallback(XPLMFlightLoop_f cb, float interval, void *ref)
+{
+    FlightLoop fl{cb, ref, -1.0, -1, now};
+    schedule(fl, interval, now);
+    flight_loops.push_back(fl);
+}
+
+void
+XPLMUnregisterFlightLoopCallback(XPLMFlightLoop_f cb, void *ref)
+{
+    std::erase_if(flight_loops, [cb, ref](const FlightLoop& fl) { return fl.cb == cb && fl.ref == ref; });
+}
+
+void
+XPLMSetFlightLoopCallbackInterval(XPLMFlightLoop_f cb, float interval, int relative_to_now, void *ref)
+{
+    for (auto& fl : flight_loops)
+        if (fl.cb == cb && fl.ref == ref)
+            schedule(fl, interval, relative_to_now ? now : fl.last_call);
+}
+
+float
+XPLMGetElapsedTime(void)
+{
+    return now;
+}
+
+void
+xps_run_frame(float dt)
+{
+    now += dt;
+    frame_cnt++;
+    xps_set("sim/time/total_running_time_sec", now);
+    xps_set("sim/operation/misc/frame_rate_period", dt);
+
+    // callbacks may register new flight loops, so no iterators
+    for (unsigned i = 0; i < flight_loops.size(); i++) {
+        FlightLoop fl = flight_loops[i];
+        bool due = (fl.next_frame >= 0 && frame_cnt >= fl.next_frame)
+                    || (fl.next_frame < 0 && fl.next_time >= 0.0 && now >= fl.next_time);
+        if (!due)
+            continue;
+
+        float elapsed = now - fl.last_call;
+        float interval = fl.cb(elapsed, elapsed, frame_cnt, fl.ref);
+        flight_loops[i].last_call = now;
+        schedule(flight_loops[i], interval, now);
+    }
+}
+
+void
+xps_set_time(double t)
+{
+    now = t;
+    xps_set("sim/time/total_running_time_sec", now);
+}
+
+void
+xps_run_loops()
+{
+    frame_cnt++;
+    for (unsigned i = 0; i < flight_loops.size(); i++) {
+        FlightLoop fl = flight_loops[i];
+        if (fl.next_frame < 0 && fl.next_time < 0.0)
+            continue;       // not scheduled
+
+        float elapsed = now - fl.last_call;
+        float interval = fl.cb(elapsed, elapsed, frame_cnt, fl.ref);
+        flight_loops[i].last_call = now;
+        schedule(flight_loops[i], interval, now);
+    }
+}
+
+double
+xps_time()
+{
+    return now;
+}
+
+//============== commands ==============================================
+struct CmdHandler {
+    XPLMCommandCallback_f cb;
+    int before;
+    void *ref;
+};
+
+struct Command {
+    std::string name;
+    std::vector<CmdHandler> handlers;
+};
+
+static std::unordered_map<std::string, std::unique_ptr<Command>> commands;
+
+XPLMCommandRef
+XPLMCreateCommand(const char *name, [[maybe_unused]] const char *descr)
+{
+    auto& c = commands[name];
+    if (c == nullptr) {
+        c = std::make_unique<Command>();
+        c->name = name;
+    }
+    return c.get();
+}
+
+XPLMCommandRef
+XPLMFindCommand(const char *name)
+{
+    auto it = commands.find(name);
+    return it == commands.end() ? nullptr : it->second.get();
+}
+
+void
+XPLMRegisterCommandHandler(XPLMCommandRef cmdr, XPLMCommandCallback_f cb, int before, void *ref)
+{
+    if (cmdr)
+        ((Command *)cmdr)->handlers.push_back({cb, before, ref});
+}
+
+void
+XPLMUnregisterCommandHandler(XPLMCommandRef cmdr, XPLMCommandCallback_f cb, int before, void *ref)
+{
+    if (cmdr)
+        std::erase_if(((Command *)cmdr)->handlers, [=](const CmdHandler& h) {
+                        return h.cb == cb && h.before == before && h.ref == ref; });
+}
+
+static void
+run_phase(Command *cmd, XPLMCommandPhase phase)
+{
+    // "before" handlers first, a handler returning 0 stops processing
+    for (int before = 1; before >= 0; before--)
+        for (auto& h : cmd->handlers)
+            if (h.before == before && h.cb(cmd, phase, h.ref) == 0)
+                return;
+}
+
+void
+XPLMCommandOnce(XPLMCommandRef cmdr)
+{
+    if (cmdr == nullptr)
+        return;
+    run_phase((Command *)cmdr, xplm_CommandBegin);
+    run_phase((Command *)cmdr, xplm_CommandEnd);
+}
+
+bool
+xps_command(const char *name)
+{
+    XPLMCommandRef cmdr = XPLMFindCommand(name);
+    if (cmdr == nullptr)
+        return false;
+
+    XPLMCommandOnce(cmdr);
+    return true;
+}
+
+//============== utilities and plugins =================================
+void
+XPLMDebugString(const char *str)
+{
+    if (!quiet)
+        fputs(str, stderr);
+}
+
+void
+xps_quiet(bool q)
+{
+    quiet = q;
+}
+
+void
+xps_set_xp_dir(const std::string& dir)
+{
+    xp_dir = dir;
+}
+
+void
+xps_set_aircraft(const std::string& path)
+{
+    acf_path = path;
+}
+
+void
+XPLMGetSystemPath(char *path)
+{
+    strcpy(path, xp_dir.c_str());
+}
+
+void
+XPLMGetPrefsPath(char *path)
+{
+    strcpy(path, (xp_dir + "Output/preferences/X-Plane.prf").c_str());
+}
+
+char *
+XPLMExtractFileAndPath(char *full_path)
+{
+    char *s = strrchr(full_path, '/');
+    if (s == nullptr)
+        return full_path;
+
+    *s = '\0';
+    return s + 1;
+}
+
+void
+XPLMGetNthAircraftModel([[maybe_unused]] int idx, char *file_name, char *path)
+{
+    strcpy(path, acf_path.c_str());
+    size_t i = acf_path.find_last_of('/');
+    strcpy(file_name, acf_path.c_str() + (i == std::string::npos ? 0 : i + 1));
+}
+
+void
+XPLMEnableFeature([[maybe_unused]] const char *feature, [[maybe_unused]] int enable)
+{
+}
+
+static std::vector<std::string> plugins;
+
+void
+xps_add_plugin(const char *signature)
+{
+    plugins.push_back(signature);
+}
+
+XPLMPluginID
+XPLMFindPluginBySignature(const char *signature)
+{
+    for (unsigned i = 0; i < plugins.size(); i++)
+        if (plugins[i] == signature)
+            return i + 1;   // 0 is X-Plane
+
+    return XPLM_NO_PLUGIN_ID;
+}
+
+int
+xps_plugin_start()
+{
+    char name[256], sig[256], desc[256];
+    if (!XPluginStart(name, sig, desc))
+        return 0;
+
+    return XPluginEnable();
+}
+
+void
+xps_plugin_stop()
+{
+    XPluginDisable();
+    XPluginStop();
+}
+
+void
+xps_message(long msg, void *param)
+{
+    XPluginReceiveMessage(0, msg, param);
+}
+
+//============== sound =================================================
+static int dummy_channel;
+
+FMOD_CHANNEL *
+XPLMPlayPCMOnBus([[maybe_unused]] void *buffer, [[maybe_unused]] uint32_t size,
+                 [[maybe_unused]] FMOD_SOUND_FORMAT format, [[maybe_unused]] int freq,
+                 [[maybe_unused]] int n_channels, [[maybe_unused]] int loop,
+                 [[maybe_unused]] XPLMAudioBus bus, [[maybe_unused]] XPLMPCMComplete_f cb,
+                 [[maybe_unused]] void *ref)
+{
+    return (FMOD_CHANNEL *)&dummy_channel;
+}
+
+FMOD_RESULT
+XPLMStopAudio([[maybe_unused]] FMOD_CHANNEL *chn)
+{
+    return FMOD_RESULT{};
+}
+
+FMOD_RESULT
+XPLMSetAudioPosition([[maybe_unused]] FMOD_CHANNEL *chn, [[maybe_unused]] FMOD_VECTOR *pos,
+                     [[maybe_unused]] FMOD_VECTOR *vel)
+{
+    return FMOD_RESULT{};
+}
+
+FMOD_RESULT
+XPLMSetAudioFadeDistance([[maybe_unused]] FMOD_CHANNEL *chn, [[maybe_unused]] float min_dist,
+                         [[maybe_unused]] float max_dist)
+{
+    return FMOD_RESULT{};
+}
+
+FMOD_RESULT
+XPLMSetAudioVolume([[maybe_unused]] FMOD_CHANNEL *chn, [[maybe_unused]] float vol)
+{
+    return FMOD_RESULT{};
+}
+
+//============== menus, widgets, display ===============================
+struct Menu {
+    std::string name;
+    std::vector<std::string> items;
+};
+
+static std::vector<std::unique_ptr<Menu>> menus;
+
+XPLMMenuID
+XPLMFindPluginsMenu(void)
+{
+    static Menu plugins_menu{"Plugins", {}};
+    return &plugins_menu;
+}
+
+XPLMMenuID
+XPLMCreateMenu(const char *name, [[maybe_unused]] XPLMMenuID parent, [[maybe_unused]] int parent_item,
+               [[maybe_unused]] XPLMMenuHandler_f handler, [[maybe_unused]] void *menu_ref)
+{
+    menus.push_back(std::make_unique<Menu>(Menu{name, {}}));
+    return menus.back().get();
+}
+
+int
+XPLMAppendMenuItem(XPLMMenuID menu, const char *name, [[maybe_unused]] void *item_ref,
+                   [[maybe_unused]] int ignored)
+{
+    auto& items = ((Menu *)menu)->items;
+    items.push_back(name);
+    return items.size() - 1;
+}
+
+int
+XPLMAppendMenuItemWithCommand(XPLMMenuID menu, const char *name, [[maybe_unused]] XPLMCommandRef cmdr)
+{
+    return XPLMAppendMenuItem(menu, name, nullptr, 0);
+}
+
+void
+XPLMAppendMenuSeparator(XPLMMenuID menu)
+{
+    XPLMAppendMenuItem(menu, "-", nullptr, 0);
+}
+
+void
+XPLMSetMenuItemName(XPLMMenuID menu, int idx, const char *name, [[maybe_unused]] int ignored)
+{
+    auto& items = ((Menu *)menu)->items;
+    if (idx >= 0 && idx < (int)items.size())
+        items[idx] = name;
+}
+
+void
+XPLMCheckMenuItem([[maybe_unused]] XPLMMenuID menu, [[maybe_unused]] int idx,
+                  [[maybe_unused]] XPLMMenuCheck check)
+{
+}
+
+void
+XPLMClearAllMenuItems(XPLMMenuID menu)
+{
+    ((Menu *)menu)->items.clear();
+}
+
+struct Widget {
+    int left, top, right, bottom;
+    bool visible;
+    std::string descr;
+    std::unordered_map<XPWidgetPropertyID, intptr_t> props;
+    std::vector<XPWidgetFunc_t> cbs;
+};
+
+static std::vector<std::unique_ptr<Widget>> widgets;
+
+XPWidgetID
+XPCreateWidget(int left, int top, int right, int bottom, int visible, const char *descr,
+               [[maybe_unused]] int is_root, [[maybe_unused]] XPWidgetID container,
+               [[maybe_unused]] XPWidgetClass wclass)
+{
+    widgets.push_back(std::make_unique<Widget>(Widget{left, top, right, bottom, visible != 0, descr, {}, {}}));
+    return widgets.back().get();
+}
+
+XPWidgetID
+XPCreateCustomWidget(int left, int top, int right, int bottom, int visible, const char *descr,
+                     int is_root, XPWidgetID container, XPWidgetFunc_t cb)
+{
+    XPWidgetID w = XPCreateWidget(left, top, right, bottom, visible, descr, is_root, container, 0);
+    XPAddWidgetCallback(w, cb);
+    return w;
+}
+
+void XPShowWidget(XPWidgetID w) { ((Widget *)w)->visible = true; }
+void XPHideWidget(XPWidgetID w) { ((Widget *)w)->visible = false; }
+int XPIsWidgetVisible(XPWidgetID w) { return w && ((Widget *)w)->visible; }
+
+void
+XPSetWidgetGeometry(XPWidgetID w, int left, int top, int right, int bottom)
+{
+    Widget *wd = (Widget *)w;
+    wd->left = left; wd->top = top; wd->right = right; wd->bottom = bottom;
+}
+
+void
+XPGetWidgetGeometry(XPWidgetID w, int *left, int *top, int *right, int *bottom)
+{
+    Widget *wd = (Widget *)w;
+    if (left) *left = wd->left;
+    if (top) *top = wd->top;
+    if (right) *right = wd->right;
+    if (bottom) *bottom = wd->bottom;
+}
+
+void
+XPSetWidgetDescriptor(XPWidgetID w, const char *descr)
+{
+    ((Widget *)w)->descr = descr;
+}
+
+void
+XPSetWidgetProperty(XPWidgetID w, XPWidgetPropertyID prop, intptr_t val)
+{
+    ((Widget *)w)->props[prop] = val;
+}
+
+intptr_t
+XPGetWidgetProperty(XPWidgetID w, XPWidgetPropertyID prop, int *exists)
+{
+    auto& props = ((Widget *)w)->props;
+    auto it = props.find(prop);
+    if (exists)
+        *exists = (it != props.end());
+    return it == props.end() ? 0 : it->second;
+}
+
+void
+XPAddWidgetCallback(XPWidgetID w, XPWidgetFunc_t cb)
+{
+    ((Widget *)w)->cbs.push_back(cb);
+}
+
+XPLMWindowID
+XPGetWidgetUnderlyingWindow(XPWidgetID w)
+{
+    return w;
+}
+
+void
+XPLMGetScreenBoundsGlobal(int *left, int *top, int *right, int *bottom)
+{
+    if (left) *left = 0;
+    if (top) *top = 1080;
+    if (right) *right = 1920;
+    if (bottom) *bottom = 0;
+}
+
+void
+XPLMSetWindowPositioningMode([[maybe_unused]] XPLMWindowID win,
+                             [[maybe_unused]] XPLMWindowPositioningMode mode,
+                             [[maybe_unused]] int monitor)
+{
+}
+
+void
+XPLMDrawString([[maybe_unused]] float *rgb, [[maybe_unused]] int x, [[maybe_unused]] int y,
+               [[maybe_unused]] const char *str, [[maybe_unused]] int *word_wrap,
+               [[maybe_unused]] XPLMFontID font)
+{
+}
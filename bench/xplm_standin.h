@@ -0,0 +1,95 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _XPLM_STANDIN_H_
+#define _XPLM_STANDIN_H_
+
+//
+// A headless stand-in for the parts of XPLM/XPWidgets that openSAM uses.
+// It lets the unmodified plugin sources run in a plain executable:
+//
+//  - datarefs: plugin accessors are dispatched, "sim/..." datarefs are
+//    created on first lookup and are set by the driver via xps_set*()
+//  - XPLMWorldToLocal/XPLMLocalToWorld use an equirectangular projection
+//    around lat_ref/lon_ref, the terrain is flat
+//  - instances, objects, sound, menus and widgets are bookkeeping only
+//  - flight loops are run by xps_run_frame()
+//
+
+#include <string>
+#include <vector>
+
+#include "XPLMDefs.h"
+#include "XPLMDataAccess.h"
+#include "XPLMScenery.h"
+
+// plugin entry points as defined in openSAM.cpp
+PLUGIN_API int XPluginStart(char *out_name, char *out_sig, char *out_desc);
+PLUGIN_API void XPluginStop(void);
+PLUGIN_API int XPluginEnable(void);
+PLUGIN_API void XPluginDisable(void);
+PLUGIN_API void XPluginReceiveMessage(XPLMPluginID in_from, long in_msg, void *in_param);
+
+// environment, must be set before xps_plugin_start()
+extern void xps_set_xp_dir(const std::string& dir);         // with trailing '/'
+extern void xps_set_aircraft(const std::string& acf_path);  // full path of the .acf
+extern void xps_add_airport(const char *icao, float lat, float lon, float elevation);
+extern void xps_add_plugin(const char *signature);          // for XPLMFindPluginBySignature
+extern void xps_quiet(bool quiet);                          // suppress XPLMDebugString output
+
+// world
+extern void xps_set_ref(double lat_ref, double lon_ref);    // origin of the local system
+extern void xps_set_terrain(double elevation);
+extern void xps_place_plane(double lat, double lon, float psi);
+
+// replay of recorded sessions: transformations and probes are asked first,
+// a hook returning false falls back to the projection / flat terrain above
+struct XpsXformHook {
+    bool (*world_to_local)(double lat, double lon, double alt, double *x, double *y, double *z);
+    bool (*local_to_world)(double x, double y, double z, double *lat, double *lon, double *alt);
+    bool (*probe)(float x, float y, float z, XPLMProbeResult *res, XPLMProbeInfo_t *info);
+};
+extern void xps_set_xform_hook(const XpsXformHook& hook);
+
+// "sim" datarefs, created if they don't exist yet
+extern XPLMDataRef xps_set(const char *name, double val);
+extern XPLMDataRef xps_set_vf(const char *name, const std::vector<float>& val);
+extern XPLMDataRef xps_set_vi(const char *name, const std::vector<int>& val);
+extern XPLMDataRef xps_set_str(const char *name, const std::string& val);
+
+// plugin life cycle and simulation
+extern int xps_plugin_start();      // XPluginStart + XPluginEnable
+extern void xps_plugin_stop();      // XPluginDisable + XPluginStop
+extern void xps_message(long msg, void *param = nullptr);
+extern void xps_run_frame(float dt);
+extern void xps_set_time(double t);     // for replay: set the clock, no flight loops
+extern void xps_run_loops();            // for replay: call all scheduled flight loops now
+extern bool xps_command(const char *name);  // begin + end phase, false if unknown
+extern double xps_time();
+
+// read function of a float accessor registered by the plugin, nullptr if none
+extern XPLMGetDataf_f xps_float_accessor(const char *name);
+
+// introspection
+extern int xps_n_instances();
+extern int xps_n_datarefs();
+
+#endif
@@ -144,11 +144,11 @@ filter_candidates(Plane& plane, std::vector<JwCtrl>& nearest_jws,
     // So we find the nearest jetways on the left and do some heuristics
 
     for (auto jw : jws) {
-        if (jw->obj_ref_gen < ref_gen)  // not visible -> not dockable
+        if (!jw->dockable())    // neither drawn nor localized -> not dockable
             continue;
 
         if (jw->locked) {
-            log_msg("pid=%02d, %s is locked", plane.id_, jw->name);
+            log_cat(kLogJw, "pid=%02d, %s is locked", plane.id_, jw->name);
             continue;
         }
 
@@ -164,26 +164,26 @@ filter_candidates(Plane& plane, std::vector<JwCtrl>& nearest_jws,
         if (njw.x_ > 1.0f || BETWEEN(RA(njw.psi_ + jw->initialRot1), -130.0f, 20.0f) ||   // on the right side or pointing away
             njw.x_ < -80.0f || fabsf(njw.z_) > 80.0f) {             // or far away
             if (fabsf(njw.x_) < 120.0f && fabsf(njw.z_) < 120.0f)   // don't pollute the log with jws VERY far away
-                log_msg("pid=%02d, too far or pointing away: %s, x: %0.2f, z: %0.2f, (njw.psi + jw->initialRot1): %0.1f",
+                log_debug("pid=%02d, too far or pointing away: %s, x: %0.2f, z: %0.2f, (njw.psi + jw->initialRot1): %0.1f",
                         plane.id_, jw->name, njw.x_, njw.z_, njw.psi_ + jw->initialRot1);
             continue;
         }
 
         if (!(BETWEEN(njw.door_rot1_, jw->minRot1, jw->maxRot1) && BETWEEN(njw.door_rot2_, jw->minRot2, jw->maxRot2)
             && BETWEEN(njw.door_extent_, jw->minExtent, jw->maxExtent))) {
-            log_msg("jw: %s for door %d, rot1: %0.1f, rot2: %0.1f, rot3: %0.1f, extent: %0.1f",
+            log_debug("jw: %s for door %d, rot1: %0.1f, rot2: %0.1f, rot3: %0.1f, extent: %0.1f",
                      jw->name, jw->door, njw.door_rot1_, njw.door_rot2_, njw.door_rot3_, njw.door_extent_);
-            log_msg("  does not fulfil min max criteria in sam.xml");
+            log_debug("  does not fulfil min max criteria in sam.xml");
             float extra_extent = njw.door_extent_ - jw->maxExtent;
             if (extra_extent < 10.0f) {
-                log_msg("  as extra extent of %0.1f m < 10.0 m we take it as a soft match", extra_extent);
+                log_debug("  as extra extent of %0.1f m < 10.0 m we take it as a soft match", extra_extent);
                 njw.soft_match_ = 1;
             } else
                 continue;
         }
 
         // ... survived, add to list
-        log_msg("--> pid=%02d, candidate %s, lib_id: %d, door %d, door frame: x: %5.3f, z: %5.3f, y: %5.3f, psi: %4.1f, "
+        log_cat(kLogJw, "--> pid=%02d, candidate %s, lib_id: %d, door %d, door frame: x: %5.3f, z: %5.3f, y: %5.3f, psi: %4.1f, "
                 "rot1: %0.1f, extent: %.1f",
                 plane.id_, jw->name, jw->library_id, jw->door,
                 njw.x_, njw.z_, njw.y_, njw.psi_, njw.door_rot1_, njw.door_extent_);
@@ -299,10 +299,10 @@ JwCtrl::collision_check(const JwCtrl &njw2)
 
     float s = det(C1, C2, B1, B2) / d;
     float t = det(A1, A2, C1, C2) / d;
-    log_msg("collision check between jw %s and %s, s = %0.2f, t = %0.2f", jw_->name, njw2.jw_->name, s, t);
+    log_cat(kLogJw, "collision check between jw %s and %s, s = %0.2f, t = %0.2f", jw_->name, njw2.jw_->name, s, t);
 
     if (BETWEEN(t, 0.0f, 1.0f) && BETWEEN(s, 0.0f, 1.0f)) {
-        log_msg("collision detected");
+        log_cat(kLogJw, "collision detected");
         return true;
     }
 
@@ -410,6 +410,33 @@ JwCtrl::animate_wheels(float ds)
     jw_->wheelrotater += da_ds;
 }
 
+// A library jetway localized from sam.xml is selected with the sam.xml geometry.
+// It is held until the first draw supplied the library values and the position
+// of the drawn object. Then the door setup is redone with them.
+bool
+JwCtrl::hold_for_geometry(Plane& plane)
+{
+    if (! jw_->has_geometry()) {
+        if (! held_)
+            log_cat(kLogJw, "pid=%02d, %s waits for library geometry", plane.id_, jw_->name);
+        held_ = true;
+        start_ts_ = std::max(start_ts_, now);
+        last_step_ts_ = start_ts_;
+        timeout_ = start_ts_ + kAnimTimeout;
+        return true;
+    }
+
+    if (held_) {
+        held_ = false;
+        log_cat(kLogJw, "pid=%02d, %s got library geometry, lib_id: %d", plane.id_, jw_->name, jw_->library_id);
+        setup_for_door(plane, plane.door_info_[door_]);
+        if (door_ == 0) // slightly slant towards the nose cone for door LF1
+            door_rot2_ += 3.0f;
+    }
+
+    return false;
+}
+
 // drive jetway to the door
 // return 1 when done
 bool
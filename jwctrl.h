@@ -70,6 +70,7 @@ class JwCtrl {
     double cabin_x_, cabin_z_;
 
     bool wait_wb_rot_;    // waiting for wheel base rotation
+    bool held_;           // waiting for the library geometry
     float wb_rot_;       // to this angle
 
     float start_ts_;     // actually start operation if now > start_ts_
@@ -113,6 +114,9 @@ class JwCtrl {
     // setup for operation
     void setup_dock_undock(float start_time, bool with_sound);
 
+    // hold a jetway without geometry, return true while held
+    bool hold_for_geometry(Plane& plane);
+
     // drive jetway, return true when done
     bool dock_drive();
     bool undock_drive();
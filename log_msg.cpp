@@ -23,27 +23,289 @@
 #include <cstdio>
 #include <cstdarg>
 #include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
 
 #ifdef LOCAL_DEBUGSTRING
+// standalone tools, nullptr is quiet
+FILE *log_local_fp = stdout;
+
 void
 XPLMDebugString(const char *str)
 {
-    fputs(str, stdout); fflush(stdout);
+    if (log_local_fp) {
+        fputs(str, log_local_fp); fflush(log_local_fp);
+    }
 }
 #else
 #include "XPLMUtilities.h"
 #endif
 
+#include "openSAM.h"
+
+//
+// In async mode messages are formatted into the slots of a lock-free ring buffer
+// (bounded MPMC queue a la Vyukov) and written in batches by log_flush() that
+// is called from the flight loop. If the ring is full messages are dropped and counted.
+// In sync mode (plugin start/stop, standalone tools) messages are written directly.
+//
+static constexpr unsigned kLogSlots = 256;  // power of 2
+static constexpr unsigned kLogSlotLen = 1024;
+static constexpr char kLogPrefix[] = "openSAM: ";
+
+struct LogSlot {
+    std::atomic<uint64_t> seq;
+    char text[kLogSlotLen];
+};
+
+static LogSlot ring[kLogSlots];
+static std::atomic<uint64_t> head;
+static uint64_t tail;                       // consumer only
+static std::atomic<bool> async_mode;
+static std::atomic<unsigned long long> n_dropped, n_msg;
+static unsigned long long n_dropped_reported;
+
+static bool ring_init = [] {
+    for (unsigned i = 0; i < kLogSlots; i++)
+        ring[i].seq.store(i, std::memory_order_relaxed);
+    return true;
+}();
+
+// format prefix + msg + '\n' into buf
+static void
+format_msg(char *buf, const char *fmt, va_list ap)
+{
+    constexpr size_t lp = sizeof(kLogPrefix) - 1;
+    memcpy(buf, kLogPrefix, lp);
+    int n = vsnprintf(buf + lp, kLogSlotLen - lp - 2, fmt, ap);
+    size_t len = lp + (n < 0 ? 0 : std::min<size_t>(n, kLogSlotLen - lp - 3));
+    buf[len] = '\n';
+    buf[len + 1] = '\0';
+}
+
+static void
+log_msgv(const char *fmt, va_list ap)
+{
+    n_msg.fetch_add(1, std::memory_order_relaxed);
+
+    if (! async_mode.load(std::memory_order_relaxed)) {
+        char line[kLogSlotLen];
+        format_msg(line, fmt, ap);
+        XPLMDebugString(line);
+        return;
+    }
+
+    // reserve a slot
+    LogSlot *slot;
+    uint64_t pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+        slot = &ring[pos & (kLogSlots - 1)];
+        int64_t d = (int64_t)slot->seq.load(std::memory_order_acquire) - (int64_t)pos;
+        if (d == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (d < 0) {     // full
+            n_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else
+            pos = head.load(std::memory_order_relaxed);
+    }
+
+    format_msg(slot->text, fmt, ap);
+    slot->seq.store(pos + 1, std::memory_order_release);
+}
+
 void
 log_msg(const char *fmt, ...)
 {
-    char line[1024];
+    va_list ap;
+    va_start(ap, fmt);
+    log_msgv(fmt, ap);
+    va_end(ap);
+}
+
+// write pending messages, must be called from XP's main thread
+void
+log_flush(void)
+{
+    char buf[8 * kLogSlotLen];
+    size_t len = 0;
+
+    for (;;) {
+        LogSlot& slot = ring[tail & (kLogSlots - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != tail + 1)
+            break;
+
+        size_t tl = strlen(slot.text);
+        if (len + tl >= sizeof(buf)) {
+            XPLMDebugString(buf);
+            len = 0;
+        }
+
+        memcpy(buf + len, slot.text, tl + 1);
+        len += tl;
+        slot.seq.store(tail + kLogSlots, std::memory_order_release);
+        tail++;
+    }
+
+    if (len > 0)
+        XPLMDebugString(buf);
+
+    unsigned long long dropped = n_dropped.load(std::memory_order_relaxed);
+    if (dropped != n_dropped_reported) {
+        snprintf(buf, sizeof(buf), "%s%llu log messages dropped\n",
+                 kLogPrefix, dropped - n_dropped_reported);
+        n_dropped_reported = dropped;
+        XPLMDebugString(buf);
+    }
+}
+
+void
+log_async(bool on)
+{
+    if (! on)
+        log_flush();
+    async_mode.store(on, std::memory_order_relaxed);
+}
+
+unsigned long long
+log_dropped(void)
+{
+    return n_dropped.load(std::memory_order_relaxed);
+}
+
+unsigned long long
+log_count(void)
+{
+    return n_msg.load(std::memory_order_relaxed);
+}
+
+//
+// Categories with token bucket rate limits.
+// A bucket holds up to 'burst' tokens and is refilled with 'rate' tokens/s,
+// each message takes one token. Messages that find an empty bucket are suppressed
+// and summarized when the next message of the category gets through.
+// rate < 0: unlimited, rate == 0: category is muted.
+// Called from XP's main thread only.
+//
+struct LogBucket {
+    const char *name;
+    float rate, burst;
+    float tokens;
+    double last_ts;
+    unsigned long long suppressed, suppressed_total;
+};
+
+static LogBucket buckets[kLogNumCat] = {
+    {"dgs",  1.5f,  3.0f, -1.0f, 0.0, 0, 0},
+    {"mp",   2.0f, 20.0f, -1.0f, 0.0, 0, 0},
+    {"jw",   5.0f, 30.0f, -1.0f, 0.0, 0, 0},
+    {"zc",   5.0f, 50.0f, -1.0f, 0.0, 0, 0},
+};
+
+static double
+mono_now()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void
+log_suppressed(LogBucket& b)
+{
+    if (b.suppressed == 0)
+        return;
+
+    log_msg("[%s] %llu messages suppressed", b.name, b.suppressed);
+    b.suppressed_total += b.suppressed;
+    b.suppressed = 0;
+}
+
+void
+log_cat(LogCat cat, const char *fmt, ...)
+{
+    LogBucket& b = buckets[cat];
+
+    // muted, the bucket would still start full
+    if (b.rate == 0.0f) {
+        b.suppressed++;
+        return;
+    }
+
+    if (b.rate > 0.0f) {
+        double ts = mono_now();
+        if (b.tokens < 0.0f)    // first use
+            b.tokens = b.burst;
+        else
+            b.tokens = std::min(b.burst, b.tokens + (float)(ts - b.last_ts) * b.rate);
+        b.last_ts = ts;
+
+        if (b.tokens < 1.0f) {
+            b.suppressed++;
+            return;
+        }
+
+        b.tokens -= 1.0f;
+    }
+
+    log_suppressed(b);
 
     va_list ap;
     va_start(ap, fmt);
-    vsnprintf(line, sizeof(line) - 3, fmt, ap);
-    strcat(line, "\n");
-    XPLMDebugString("openSAM: ");
-    XPLMDebugString(line);
+    log_msgv(fmt, ap);
     va_end(ap);
 }
+
+// lines of "<category> <rate msg/s> <burst>", '#' starts a comment
+void
+log_load_config(const std::string& fn)
+{
+    std::ifstream f(fn);
+    if (! f.is_open())
+        return;
+
+    std::string line;
+    while (std::getline(f, line)) {
+        size_t i = line.find_first_of("#\r");
+        if (i != std::string::npos)
+            line.resize(i);
+
+        std::istringstream is(line);
+        std::string name;
+        float rate, burst;
+        if (! (is >> name))
+            continue;
+
+        if (! (is >> rate >> burst)) {
+            log_msg("log config: invalid line for '%s'", name.c_str());
+            continue;
+        }
+
+        auto b = std::find_if(std::begin(buckets), std::end(buckets),
+                              [&name] (const LogBucket& b) { return name == b.name; });
+        if (b == std::end(buckets)) {
+            log_msg("log config: unknown category '%s'", name.c_str());
+            continue;
+        }
+
+        b->rate = rate;
+        b->burst = std::max(burst, 1.0f);
+        b->tokens = -1.0f;
+        log_msg("log category %s: rate: %0.1f/s, burst: %0.0f", b->name, b->rate, b->burst);
+    }
+}
+
+// flush pending summaries and log totals
+void
+log_cat_stats(void)
+{
+    for (auto& b : buckets) {
+        log_suppressed(b);
+        log_msg("log category %-4s suppressed: %llu", b.name, b.suppressed_total);
+    }
+}
@@ -21,6 +21,8 @@
 */
 
 #include <cassert>
+#include <algorithm>
+#include <chrono>
 #include "openSAM.h"
 #include "plane.h"
 
@@ -28,9 +30,101 @@
 #include "mpadapter_xpilot.h"
 #include "mpadapter_tgxp.h"
 #include "mpadapter_lt.h"
+#include "mpadapter_composite.h"
+#include "os_trace.h"
+#include "os_stats.h"
+
+// new planes are spawned nearest first until this budget per frame is used up
+constexpr auto kSpawnBudget = std::chrono::microseconds(2000);
+constexpr float kSpawnNextFrame = -1.0f;    // flight loop: call again in the next frame
 
 static bool active;
 
+//==============  TrafficSnapshot ========================================
+void
+TrafficSnapshot::clear()
+{
+    key.clear();
+    x.clear(); y.clear(); z.clear(); psi.clear();
+    phase.clear();
+    beacon.clear(); engines_on.clear();
+    slot.clear();
+    str_ofs.clear();
+    strings.clear();
+}
+
+void
+TrafficSnapshot::add(uint64_t key_, float x_, float y_, float z_, float psi_, Phase phase_,
+                     bool beacon_, bool engines_on_, int slot_, const char *icao, const char *flight_id)
+{
+    key.push_back(key_);
+    x.push_back(x_); y.push_back(y_); z.push_back(z_); psi.push_back(psi_);
+    phase.push_back(phase_);
+    beacon.push_back(beacon_); engines_on.push_back(engines_on_);
+    slot.push_back(slot_);
+
+    str_ofs.push_back(strings.size());
+    strings.insert(strings.end(), icao, icao + strlen(icao) + 1);
+    strings.insert(strings.end(), flight_id, flight_id + strlen(flight_id) + 1);
+}
+
+uint64_t
+TrafficSnapshot::hash(const char *s)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+//==============  SpatialHash ========================================
+void
+SpatialHash::clear()
+{
+    // keep the storage of the cells used in the last round, drop the others
+    // so the map does not grow with every cell touched on a long flight
+    for (auto it = cells_.begin(); it != cells_.end();) {
+        if (it->second.empty()) {
+            it = cells_.erase(it);
+        } else {
+            it->second.clear();
+            it++;
+        }
+    }
+}
+
+void
+SpatialHash::insert(float x, float z, const MpAdapter *owner)
+{
+    int cx = (int)floorf(x / kCell);
+    int cz = (int)floorf(z / kCell);
+    cells_[cell_key(cx, cz)].push_back({x, z, owner});
+}
+
+bool
+SpatialHash::occupied(float x, float z, const MpAdapter *owner) const
+{
+    int cx = (int)floorf(x / kCell);
+    int cz = (int)floorf(z / kCell);
+
+    for (int i = cx - 1; i <= cx + 1; i++)
+        for (int j = cz - 1; j <= cz + 1; j++) {
+            auto it = cells_.find(cell_key(i, j));
+            if (it == cells_.end())
+                continue;
+
+            for (auto & e : it->second)
+                if (e.owner != owner && len2f(e.x - x, e.z - z) < kCell)
+                    return true;
+        }
+
+    return false;
+}
+
+//==============  MpAdapter ========================================
+
 MpAdapter::~MpAdapter()
 {
     mp_planes_.clear();
@@ -43,20 +137,191 @@ std::unique_ptr<MpAdapter> MpAdapter_factory()
     assert(!active);
 
     std::unique_ptr<MpAdapter> adapter;
+    std::vector<std::unique_ptr<MpAdapter>> sources;
 
+    // order of updates in a composite, there is no precedence:
+    // on a shared stand the plane that is spawned first wins
     if (MpAdapter_xPilot::probe())
-        adapter = std::unique_ptr<MpAdapter>(new MpAdapter_xPilot());
-    else if (MpAdapter_lt::probe())
-        adapter = std::unique_ptr<MpAdapter>(new MpAdapter_lt());
-    else if (MpAdapter_tgxp::probe())
-        adapter = std::unique_ptr<MpAdapter>(new MpAdapter_tgxp());
+        sources.emplace_back(new MpAdapter_xPilot());
+    if (MpAdapter_lt::probe())
+        sources.emplace_back(new MpAdapter_lt());
+    if (MpAdapter_tgxp::probe())
+        sources.emplace_back(new MpAdapter_tgxp());
+
+    if (sources.size() == 1)
+        adapter = std::move(sources[0]);
+    else if (sources.size() > 1)
+        adapter = std::unique_ptr<MpAdapter>(new MpAdapter_composite(std::move(sources)));
 
     active = (adapter != nullptr);
     return adapter;
 }
 
+float
+MpAdapter::update()
+{
+    TRACE_SCOPE("MpAdapter::update");
+    ALLOC_SCOPE(kAllocMp);
+    // snapshot is still fresh, just continue spawning
+    if (!spawn_queue_.empty() && now < next_fetch_ts_) {
+        drain_spawn_queue();
+        return spawn_queue_.empty() ? next_fetch_ts_ - now : kSpawnNextFrame;
+    }
+
+    snapshot_.clear();
+    float delay = fetch(snapshot_);
+    next_fetch_ts_ = now + delay;
+    process_snapshot();
+    drain_spawn_queue();
+    return spawn_queue_.empty() ? delay : kSpawnNextFrame;
+}
+
+void
+MpAdapter::process_snapshot()
+{
+    const TrafficSnapshot& ts = snapshot_;
+    const int n = ts.size();
+
+    // distance filter as a plain loop over the columns so the compiler can vectorize it
+    dist2_.resize(n);
+    const float mx = my_plane.x();
+    const float mz = my_plane.z();
+    const float *x = ts.x.data();
+    const float *z = ts.z.data();
+    float *dist2 = dist2_.data();
+    for (int i = 0; i < n; i++) {
+        float dx = x[i] - mx;
+        float dz = z[i] - mz;
+        dist2[i] = dx * dx + dz * dz;
+    }
+
+    // diff against live planes: update existing ones, queue new ones
+    constexpr float max_dist2 = kMpMaxDist * kMpMaxDist;
+    gen_++;
+    spawn_queue_.clear();
+    for (int i = 0; i < n; i++) {
+        if (dist2[i] > max_dist2)
+            continue;
+
+        auto it = mp_planes_.find(ts.key[i]);
+        if (it != mp_planes_.end()) {
+            it->second->seen_gen_ = gen_;
+            it->second->update(ts, i);
+            continue;
+        }
+
+        // new creation only in parked state
+        if (ts.phase[i] == TrafficSnapshot::kParked)
+            spawn_queue_.push_back({dist2[i], i});
+    }
+
+    // nearest planes first, drain_spawn_queue() pops from the back
+    std::sort(spawn_queue_.begin(), spawn_queue_.end(),
+              [](const SpawnCand& a, const SpawnCand& b) { return a.dist2 > b.dist2; });
+
+    // keep first seen timestamps of the queued planes only
+    auto tp_now = std::chrono::steady_clock::now();
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> first_seen;
+    first_seen.reserve(spawn_queue_.size());
+    for (auto & c : spawn_queue_) {
+        uint64_t key = ts.key[c.row];
+        auto it = first_seen_.find(key);
+        first_seen[key] = (it != first_seen_.end() ? it->second : tp_now);
+    }
+    first_seen_.swap(first_seen);
+
+    // delete the planes that are no longer in the snapshot
+    for (auto it = mp_planes_.begin(); it != mp_planes_.end(); ) {
+        if (it->second->seen_gen_ != gen_) {
+            log_cat(kLogMp, "pid=%d not longer exists, deleted", it->second->id_);
+            it = mp_planes_.erase(it);
+        } else
+            it++;
+    }
+
+    log_cat(kLogMp, "------------------ MP active planes found: %d, spawn queue: %d -----------------",
+            (int)mp_planes_.size(), (int)spawn_queue_.size());
+}
+
+// spawn queued planes until the time budget of this frame is exhausted
+void
+MpAdapter::drain_spawn_queue()
+{
+    if (spawn_queue_.empty())
+        return;
+
+    const TrafficSnapshot& ts = snapshot_;
+    auto deadline = std::chrono::steady_clock::now() + kSpawnBudget;
+    int n_spawned = 0;
+
+    // at least one plane per frame
+    while (!spawn_queue_.empty()
+           && (n_spawned == 0 || std::chrono::steady_clock::now() < deadline)) {
+        int i = spawn_queue_.back().row;
+        spawn_queue_.pop_back();
+
+        // stand is already occupied by a plane of another source
+        if (dedup_ && dedup_->occupied(ts.x[i], ts.z[i], this))
+            continue;
+
+        MpPlane *mp_plane = create_plane(ts, i);
+        mp_plane->seen_gen_ = gen_;
+        mp_plane->update(ts, i);
+        mp_planes_.emplace(ts.key[i], mp_plane);
+        n_spawned++;
+
+        auto it = first_seen_.find(ts.key[i]);
+        if (it != first_seen_.end()) {
+            spawn_latency_.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now()
+                                                                              - it->second).count());
+            first_seen_.erase(it);
+        }
+    }
+
+    if (spawn_queue_.empty())
+        log_spawn_latency();
+}
+
+void
+MpAdapter::log_spawn_latency()
+{
+    int n = spawn_latency_.size();
+    if (n == 0)
+        return;
+
+    auto pct = [&](int p) {
+        auto it = spawn_latency_.begin() + std::min(n - 1, n * p / 100);
+        std::nth_element(spawn_latency_.begin(), it, spawn_latency_.end());
+        return *it;
+    };
+
+    float p50 = pct(50);
+    float p90 = pct(90);
+    float p99 = pct(99);
+    float max = *std::max_element(spawn_latency_.begin(), spawn_latency_.end());
+    log_msg("%s: spawned %d planes, latency p50: %0.1f ms, p90: %0.1f ms, p99: %0.1f ms, max: %0.1f ms",
+            personality(), n, p50, p90, p99, max);
+    spawn_latency_.clear();
+}
+
+void
+MpAdapter::state_counts(unsigned *counts) const
+{
+    for (auto const& p : mp_planes_)
+        counts[p.second->state()]++;
+}
+
+void
+MpAdapter::live_planes(std::vector<const MpPlane *>& planes) const
+{
+    for (auto const& p : mp_planes_)
+        planes.push_back(p.second.get());
+}
+
 float
 MpAdapter::jw_state_machine() {
+    TRACE_SCOPE("MpAdapter::jw_state_machine");
+    ALLOC_SCOPE(kAllocMp);
     float jw_loop_delay = 10.0;
     for (auto & p : mp_planes_)
         jw_loop_delay = std::min(p.second->jw_state_machine(), jw_loop_delay);
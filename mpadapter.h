@@ -22,24 +22,127 @@
 #ifndef _MPADAPTER_H_
 #define _MPADAPTER_H_
 
+#include <cstdint>
+#include <cstring>
+#include <chrono>
 #include <unordered_map>
+#include <vector>
 #include <memory>
 
 #include "plane.h"
 
+// Columnar (SoA) snapshot of the traffic reported by an MP plugin.
+// Adapters only fill it, the shared stage in MpAdapter::update() does the rest.
+struct TrafficSnapshot {
+    enum Phase : uint8_t { kParked = 0, kStartup, kTaxi, kOther };
+
+    std::vector<uint64_t> key;          // hash of the source's unique id
+    std::vector<float> x, y, z, psi;    // local coordinates
+    std::vector<uint8_t> phase;         // only kParked planes are spawned
+    std::vector<uint8_t> beacon, engines_on;
+    std::vector<int> slot;              // index in the source's arrays, for logging
+    std::vector<uint32_t> str_ofs;      // into strings: icao '\0' flight_id '\0'
+    std::vector<char> strings;
+
+    int size() const { return (int)key.size(); }
+    void clear();
+    void add(uint64_t key, float x, float y, float z, float psi, Phase phase,
+             bool beacon, bool engines_on, int slot, const char *icao, const char *flight_id);
+
+    const char *icao(int i) const { return strings.data() + str_ofs[i]; }
+    const char *flight_id(int i) const { return icao(i) + strlen(icao(i)) + 1; }
+
+    static uint64_t hash(const char *s);    // FNV-1a
+};
+
+// Base class of planes provided by MP plugins
+class MpPlane : public Plane {
+    friend class MpAdapter;
+    unsigned seen_gen_{0};   // last snapshot that contained this plane
+
+  protected:
+    std::string flight_id_;
+
+  public:
+    const std::string& flight_id() const { return flight_id_; }
+
+    // update from row i of the snapshot
+    virtual void update(const TrafficSnapshot& ts, int i) = 0;
+
+    bool auto_mode() const override { return true; }
+    bool dock_requested() override { return true; }
+};
+
+class MpAdapter;
+
+// Spatial hash over the live planes of several adapters.
+// Used to detect that a plane of one source occupies a stand that is
+// already taken by a plane of another source.
+class SpatialHash {
+    static constexpr float kCell = 10.0f;   // (m) cell size == max distance for a match
+    struct Entry {
+        float x, z;
+        const MpAdapter *owner;
+    };
+    std::unordered_map<uint64_t, std::vector<Entry>> cells_;
+
+    static uint64_t cell_key(int cx, int cz) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cz; }
+
+  public:
+    void clear();
+    void insert(float x, float z, const MpAdapter *owner);
+
+    // is there a plane of another owner within kCell?
+    bool occupied(float x, float z, const MpAdapter *owner) const;
+};
+
 // Wrapper around the different plugins providing multiplayer planes
 // xPilot, TGXP, liveTraffic, ...
 class MpAdapter {
+    friend class MpAdapter_composite;
+
+    unsigned gen_{0};                   // snapshot generation
+    float next_fetch_ts_{0};            // snapshot is fresh until then
+    std::vector<float> dist2_;          // scratch column of the distance filter
+    const SpatialHash *dedup_{nullptr}; // set when running as part of a composite
+
+    // planes waiting for creation, sorted by descending distance
+    struct SpawnCand {
+        float dist2;
+        int row;        // in snapshot_
+    };
+    std::vector<SpawnCand> spawn_queue_;
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> first_seen_;
+    std::vector<float> spawn_latency_;  // (ms) first seen -> spawned
+
+    void drain_spawn_queue();
+    void log_spawn_latency();
+
   protected:
-    std::unordered_map<std::string, std::unique_ptr<Plane>> mp_planes_;
-    MpAdapter() {};
+    std::unordered_map<uint64_t, std::unique_ptr<MpPlane>> mp_planes_;
+    TrafficSnapshot snapshot_;
+
+    // fill snapshot with the current traffic, return delay to next call
+    virtual float fetch(TrafficSnapshot& ts) = 0;
+
+    // create a plane for row i of the snapshot
+    virtual MpPlane *create_plane(const TrafficSnapshot& ts, int i) = 0;
+
+    // filter, diff, queue spawns + delete
+    void process_snapshot();
 
   public:
     virtual ~MpAdapter();
     virtual const char* personality() const = 0;
 
-    virtual float update() = 0;     // update status of MP planes
-    float jw_state_machine();       // return delay to next call
+    virtual float update();         // update status of MP planes
+    virtual float jw_state_machine();   // return delay to next call
+
+    // add # of planes per Plane::State to counts[]
+    virtual void state_counts(unsigned *counts) const;
+
+    // append all live planes to planes, e.g. for load tests
+    virtual void live_planes(std::vector<const MpPlane *>& planes) const;
 };
 
 // hopefully will detect which plugin is active and returns the appropriate service
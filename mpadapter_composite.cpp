@@ -0,0 +1,108 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <chrono>
+
+#include "openSAM.h"
+#include "plane.h"
+#include "mpadapter_composite.h"
+
+MpAdapter_composite::MpAdapter_composite(std::vector<std::unique_ptr<MpAdapter>> sources)
+{
+    for (auto & a : sources) {
+        if (personality_.size() > 0)
+            personality_ += '+';
+        personality_ += a->personality();
+        a->dedup_ = &dedup_hash_;
+        sources_.push_back({std::move(a)});
+    }
+
+    log_msg("MpAdapter_composite constructor: %s", personality_.c_str());
+}
+
+MpAdapter_composite::~MpAdapter_composite()
+{
+    for (auto & s : sources_)
+        log_msg("MP source %s: updates: %u, avg: %0.3f ms, max: %0.3f ms",
+                s.adapter->personality(), s.n_update,
+                s.n_update > 0 ? s.total_ms / s.n_update : 0.0, s.max_ms);
+
+    log_msg("MpAdapter_composite destructor");
+}
+
+float
+MpAdapter_composite::update()
+{
+    float delay = 10.0f;
+
+    for (auto & s : sources_) {
+        if (now >= s.next_ts) {
+            // collect the live planes of all sources, including the ones just spawned by
+            // sources updated before this one
+            dedup_hash_.clear();
+            for (auto & o : sources_)
+                for (auto & p : o.adapter->mp_planes_)
+                    dedup_hash_.insert(p.second->x(), p.second->z(), o.adapter.get());
+
+            auto t0 = std::chrono::steady_clock::now();
+            float d = s.adapter->update();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+            s.next_ts = now + d;
+            s.n_update++;
+            s.total_ms += ms;
+            s.last_ms = ms;
+            s.max_ms = std::max(s.max_ms, ms);
+
+            log_cat(kLogMp, "MP source %s: planes: %d, update: %0.3f ms, avg: %0.3f ms, max: %0.3f ms",
+                    s.adapter->personality(), (int)s.adapter->mp_planes_.size(),
+                    ms, s.total_ms / s.n_update, s.max_ms);
+        }
+
+        delay = std::min(delay, s.next_ts - now);
+    }
+
+    return delay;
+}
+
+float
+MpAdapter_composite::jw_state_machine()
+{
+    float delay = 10.0;
+    for (auto & s : sources_)
+        delay = std::min(delay, s.adapter->jw_state_machine());
+    return delay;
+}
+
+void
+MpAdapter_composite::state_counts(unsigned *counts) const
+{
+    for (auto const& s : sources_)
+        s.adapter->state_counts(counts);
+}
+
+void
+MpAdapter_composite::live_planes(std::vector<const MpPlane *>& planes) const
+{
+    for (auto const& s : sources_)
+        s.adapter->live_planes(planes);
+}
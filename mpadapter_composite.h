@@ -0,0 +1,65 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _MPADAPTER_COMPOSITE_H_
+#define _MPADAPTER_COMPOSITE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mpadapter.h"
+
+// Runs several MP sources at once, e.g. TGXP background traffic + xPilot online traffic.
+// A plane is only spawned if its stand is not occupied by a plane of another source.
+class MpAdapter_composite : public MpAdapter {
+    struct Source {
+        std::unique_ptr<MpAdapter> adapter;
+        float next_ts{0};
+
+        // update cost stats
+        unsigned n_update{0};
+        double total_ms{0}, max_ms{0}, last_ms{0};
+    };
+
+    std::vector<Source> sources_;
+    std::string personality_;
+    SpatialHash dedup_hash_;
+
+    friend std::unique_ptr<MpAdapter> MpAdapter_factory();
+
+  protected:
+    MpAdapter_composite(std::vector<std::unique_ptr<MpAdapter>> sources);
+
+    // not used, the sources do the work
+    float fetch([[maybe_unused]] TrafficSnapshot& ts) override { return 10.0f; }
+    MpPlane *create_plane([[maybe_unused]] const TrafficSnapshot& ts,
+                          [[maybe_unused]] int i) override { return nullptr; }
+
+  public:
+    ~MpAdapter_composite();
+    const char* personality() const override { return personality_.c_str(); };
+    float update() override;
+    float jw_state_machine() override;
+    void state_counts(unsigned *counts) const override;
+    void live_planes(std::vector<const MpPlane *>& planes) const override;
+};
+#endif
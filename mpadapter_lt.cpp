@@ -29,12 +29,9 @@
 #include "plane.h"
 #include "mpadapter_lt.h"
 
-constexpr int kSpawnPerRun = 10;    // new Planes per update run
 constexpr float kDefaultWait = 3.0; // s
 
-class MpPlane_lt : public Plane {
-    std::string flight_id_;
-
+class MpPlane_lt : public MpPlane {
     float scan_mp_planes();
 
   public:
@@ -42,10 +39,7 @@ class MpPlane_lt : public Plane {
                float x, float y, float z, float psi);
     ~MpPlane_lt() override {}
 
-    void update(bool beacon);
-
-    bool auto_mode() const override { return true; }
-    bool dock_requested() override { return true; }
+    void update(const TrafficSnapshot& ts, int i) override;
 };
 
 
@@ -57,62 +51,53 @@ MpPlane_lt::MpPlane_lt(const std::string& flight_id, const std::string& icao,
     on_ground_ = true;  // otherwise we were not here
     parkbrake_set_ = true;
 
-    log_msg("pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), icao.c_str());
+    log_cat(kLogMp, "pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), icao.c_str());
 
-    n_door_ = 0;
-    try {
-        // first an optional translation to a generic icao code
-        try {
-            icao_ = acf_generic_type_map.at(icao);
-        } catch(const std::out_of_range& ex) {
-            icao_ = icao;
-        }
+    // first an optional translation to a generic icao code
+    auto git = acf_generic_type_map.find(icao);
+    icao_ = (git != acf_generic_type_map.end() ? git->second : icao);
 
-        door_info_[0] = csl_door_info_map.at(icao_ + '1');
-        n_door_++;
+    // door 1 is mandatory, door 2 + 3 are optional
+    const DoorInfoRec *dir = csl_door_info_table.find(icao_);
+    if (dir == nullptr || dir->n_door == 0) {
+        log_msg("pid=%d, %s: door 1 is not defined in door_info_table, deactivating slot", id_, icao_.c_str());
+        state_ = DISABLED;
+        return;
+    }
 
-        x_ = x; z_ = z; psi_ = psi;
+    n_door_ = dir->n_door;
+    for (unsigned i = 0; i < n_door_; i++)
+        door_info_[i] = dir->door[i];
 
-        // refine y for ground level
-        if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
-            log_msg("terrain probe failed???");
-        }
-        y_ = probeinfo.locationY;
+    x_ = x; z_ = z; psi_ = psi;
 
-        log_msg("pid=%d, icao: %s, found door 1 in door_info_map: x: %0.2f, y: %0.2f, z: %0.2f",
-                id_, icao_.c_str(), door_info_[0].x, door_info_[0].y, door_info_[0].z);
-    } catch(const std::out_of_range& ex) {
-        log_msg("pid=%d, %s: door 1 is not defined in door_info_map, deactivating slot", id_, icao_.c_str());
-        state_ = DISABLED;
-        return;
+    // refine y for ground level
+    if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
+        log_msg("terrain probe failed???");
     }
+    y_ = probeinfo.locationY;
 
-    // door 2 + 3 are optional
-    try {
-        door_info_[1] = csl_door_info_map.at(icao_ + '2');
-        n_door_++;
-        door_info_[2] = csl_door_info_map.at(icao_ + '3');
-        n_door_++;
-    } catch(const std::out_of_range& ex) {}
+    log_cat(kLogMp, "pid=%d, icao: %s, found door 1 in door_info_table: x: %0.2f, y: %0.2f, z: %0.2f",
+            id_, icao_.c_str(), door_info_[0].x, door_info_[0].y, door_info_[0].z);
 
     state_ = IDLE;
 }
 
 void
-MpPlane_lt::update(bool beacon)
+MpPlane_lt::update(const TrafficSnapshot& ts, int i)
 {
     if (state_ == DISABLED)
         return;
 
-    beacon_on_ = beacon;
+    beacon_on_ = ts.beacon[i];
 
-    // Jetways are only dockable if they were rendered once.
-    // As they come in view over time we just retry a docking attempt if the plane is stuck
-    // in CANT_DOCK.
+    // Jetways are only dockable if they were rendered once or localized from sam.xml.
+    // Sceneries come in range of the localization pass over time so we just retry a docking
+    // attempt if the plane is stuck in CANT_DOCK.
     if (!beacon_on_ && state_ == CANT_DOCK && now > state_change_ts_ + 60.0f)
         state_ = PARKED;
 
-    log_msg("MP update: pid=%02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, state: %s",
+    log_debug("MP update: pid=%02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, state: %s",
             id_, icao_.c_str(), flight_id_.c_str(), beacon_on_, parkbrake_set_,
             state_str_[state_]);
 
@@ -134,22 +119,44 @@ MpAdapter_lt::~MpAdapter_lt()
     log_msg("MpAdapter_lt destructor");
 }
 
-// static
-float MpAdapter_lt::update()
+// prefilter for LTAPIConnect::UpdateAcListFiltered()
+// only planes on ground and within kMpMaxDist are of interest
+struct LtFilterRef {
+    float lat, lon, cos_lat;
+};
+
+static bool
+lt_filter(const LTAPIAircraft::LTAPIBulkData& bulk, void *ref)
+{
+    if (!bulk.bits.onGnd)
+        return false;
+
+    const LtFilterRef& fr = *static_cast<const LtFilterRef*>(ref);
+    return len2f((float(bulk.lon) - fr.lon) * fr.cos_lat, float(bulk.lat) - fr.lat) * LAT_2_M <= kMpMaxDist;
+}
+
+MpPlane *
+MpAdapter_lt::create_plane(const TrafficSnapshot& ts, int i)
+{
+    return new MpPlane_lt(ts.flight_id(i), ts.icao(i), ts.x[i], ts.y[i], ts.z[i], ts.psi[i]);
+}
+
+float
+MpAdapter_lt::fetch(TrafficSnapshot& ts)
 {
     float my_lat = my_plane.lat();
     float my_lon = my_plane.lon();
     float my_cos_lat = cosf(my_lat * D2R);
 
-    lt_connect_.UpdateAcList();
-    const MapLTAPIAircraft& lt_planes = lt_connect_.getAcMap();
+    LtFilterRef filter_ref{my_lat, my_lon, my_cos_lat};
+    const MapLTAPIAircraft& lt_planes = lt_connect_.UpdateAcListFiltered(lt_filter, &filter_ref);
 
-    int spawn_remain = kSpawnPerRun;
     for (auto & mltp : lt_planes) {
         const LTAPIAircraft& lt_plane = *mltp.second;
 
         // filter, optimize for reject, order cheap to expensive
-        if (!(lt_plane.isOnGnd() && lt_plane.isVisible()))
+        // on ground and distance are already checked by the prefilter
+        if (!lt_plane.isVisible())
             continue;
 
         LTAPIAircraft::LTFlightPhase flight_phase = lt_plane.getPhase();
@@ -160,45 +167,19 @@ float MpAdapter_lt::update()
         if (flight_id.size() == 0)       // likely a ground vehicle
             continue;
 
-        if (len2f((lt_plane.getLon() - my_lon) * my_cos_lat,
-                   lt_plane.getLat() - my_lat) * LAT_2_M > kMpMaxDist)
-            continue;
-
         //log_msg("LT lat/lon: %0.2f, %0.2f", lt_plane.getLat(), lt_plane.getLon());
         double x, y, z;
         lt_plane.getLocalCoord(x, y, z);
         float psi = lt_plane.getHeading();      // TODO: mag to true adjustment
 
-        const std::string& icao = lt_plane.getModelIcao();
-        const std::string& key = lt_plane.getKey();
-
-        try {
-            auto & pr = mp_planes_.at(key);
-            MpPlane_lt* mp_plane = static_cast<MpPlane_lt*>(pr.get());
-            mp_plane->update(lt_plane.getLights().beacon);
-        } catch(const std::out_of_range& ex) {
-            if (flight_phase == LTAPIAircraft::FPH_PARKED) {    // new creation only in parked state
-                if (--spawn_remain < 0)
-                    break;
-                mp_planes_.emplace(key, new MpPlane_lt(flight_id, icao, x, y, z, psi));
-            }
-        }
-        //log_msg("LT: %d, %s, %s %0.2f, %0.2f, %0.2f",
-        //        flight_phase, flight_id.c_str(), icao.c_str(), x, y, z);
+        ts.add(TrafficSnapshot::hash(mltp.first.c_str()), x, y, z, psi,
+               flight_phase == LTAPIAircraft::FPH_PARKED ? TrafficSnapshot::kParked : TrafficSnapshot::kTaxi,
+               lt_plane.getLights().beacon, false, 0,
+               lt_plane.getModelIcao().c_str(), flight_id.c_str());
     }
 
-    // loop over mp_planes and delete the ones that are no longer in drefs
-    for (auto & mp : mp_planes_) {
-        const std::string& key = mp.first;
-        Plane& plane = *(mp.second);
-
-        try {
-            lt_planes.at(key);
-        } catch(const std::out_of_range& ex) {
-            log_msg("pid=%d not longer exists, deleted", plane.id_);
-            mp_planes_.erase(key);
-        }
-    }
-    log_msg("------------------ MP active planes found: %d -----------------", (int)mp_planes_.size());
+    const LTAPIConnect::UpdateStats& us = lt_connect_.getUpdateStats();
+    log_cat(kLogMp, "LT update: aircraft: %d, kept: %d, info texts: %d, bytes received: %d",
+            us.numAc, us.numKept, us.numInfo, (int)us.bytesRcvd);
     return kDefaultWait;
 }
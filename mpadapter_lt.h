@@ -35,9 +35,11 @@ class MpAdapter_lt : public MpAdapter {
     static bool probe();        // probe whether xPilot is active
     MpAdapter_lt();
 
+    float fetch(TrafficSnapshot& ts) override;
+    MpPlane *create_plane(const TrafficSnapshot& ts, int i) override;
+
   public:
     ~MpAdapter_lt();
     const char* personality() const override { return "LiveTraffic"; };
-    float update() override;
 };
 #endif
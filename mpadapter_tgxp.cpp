@@ -29,8 +29,6 @@
 #include "plane.h"
 #include "mpadapter_tgxp.h"
 
-constexpr int kSpawnPerRun = 10;    // new Planes per update run
-
 static XPLMDataRef
     flight_phase_dr,
     traffic_type_dr,
@@ -62,10 +60,8 @@ enum TrafficType
 	PT_Military,
 };
 
-class MpPlane_tgxp : public Plane {
+class MpPlane_tgxp : public MpPlane {
     const int slot_;
-    std::string flight_id_;
-
     float scan_mp_planes();
 
   public:
@@ -73,22 +69,31 @@ class MpPlane_tgxp : public Plane {
                  float x, float y, float z, float psi);
     ~MpPlane_tgxp() override {}
 
-    void update(bool beacon);
+    void update(const TrafficSnapshot& ts, int i) override;
+};
 
-    bool auto_mode() const override { return true; }
-    bool dock_requested() override { return true; }
+
+// resolved type code of a traffic pack's aircraft code
+struct TypeMemo {
+    bool valid;     // false = no type code or no door 1, negative results are memorized as well
+    std::string icao;
+    const DoorInfoRec *doors;   // table is static after startup
 };
 
+// aircraft code -> TypeMemo
+static std::unordered_map<std::string, TypeMemo> type_memo;
 
-MpPlane_tgxp::MpPlane_tgxp(int slot, const std::string& flight_id, const std::string& acf_type,
-                           float x, float y, float z, float psi) : slot_(slot)
+static const TypeMemo&
+resolve_acf_type(const std::string& acf_type)
 {
-    flight_id_ = flight_id;
-
-    on_ground_ = true;  // otherwise we were not here
-    parkbrake_set_ = true;
+    auto it = type_memo.find(acf_type);
+    if (it != type_memo.end()) {
+        stat_type_memo_hit++;
+        return it->second;
+    }
 
-    log_msg("pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), acf_type.c_str());
+    stat_type_memo_miss++;
+    TypeMemo tm{};
 
     // now check if acf_type is of some traffic pack and
     // e.g. is "332_EUROWINGSDISCOVER_WE_RD" or "JFAI_A220_300_SWISS"
@@ -97,84 +102,94 @@ MpPlane_tgxp::MpPlane_tgxp(int slot, const std::string& flight_id, const std::st
     if (acf_type.find('_') == std::string::npos)
         type_code = acf_type;
     else {
-        std::string s = acf_type;
-        size_t pos;
-        while ((pos = s.find('_')) != std::string::npos) {
-            std::string token = s.substr(0, pos);
-            s.erase(0, pos + 1);
-            if (token.find_first_of("0123456789") != std::string::npos) {
-                type_code = token;
-                log_msg("extracted type code '%s'", type_code.c_str());
+        size_t start = 0, pos;
+        while ((pos = acf_type.find('_', start)) != std::string::npos) {
+            size_t d = acf_type.find_first_of("0123456789", start);
+            if (d < pos) {
+                type_code = acf_type.substr(start, pos - start);
                 break;
             }
+            start = pos + 1;
         }
     }
 
-    if (type_code.size() == 0) {
-        log_msg("pid=%d, could not extract type code from '%s'", id_, acf_type.c_str());
-        state_ = DISABLED;
-        return;
-    }
-
-    n_door_ = 0;
-    try {
+    if (type_code.size() == 0)
+        log_msg("could not extract type code from '%s'", acf_type.c_str());
+    else {
         // first an optional translation to icao code
-        try {
-            icao_ = acf_generic_type_map.at(type_code);
-        } catch(const std::out_of_range& ex) {
-            icao_ = type_code;
-        }
+        auto git = acf_generic_type_map.find(type_code);
+        tm.icao = (git != acf_generic_type_map.end() ? git->second : type_code);
+
+        // door 1 is mandatory, door 2 + 3 are optional
+        tm.doors = csl_door_info_table.find(tm.icao);
+        tm.valid = (tm.doors && tm.doors->n_door > 0);
+        if (!tm.valid)
+            log_msg("%s: door 1 is not defined in door_info_table", tm.icao.c_str());
+    }
 
-        door_info_[0] = csl_door_info_map.at(icao_ + '1');
-        n_door_++;
+    unsigned long long n = stat_type_memo_hit + stat_type_memo_miss;
+    log_msg("resolved '%s' -> '%s', valid: %d, doors: %d, memo hit rate: %0.1f%% of %llu",
+            acf_type.c_str(), tm.icao.c_str(), tm.valid, tm.valid ? tm.doors->n_door : 0,
+            100.0 * stat_type_memo_hit / n, n);
+    return type_memo.emplace(acf_type, std::move(tm)).first->second;
+}
 
-        // lateral adjustment
-        constexpr float z_adjust = 1.0f;      // backwards
-        x_ = x + -sinf(D2R * psi) * z_adjust;
-        z_ = z + cosf(D2R * psi) * z_adjust;
+MpPlane_tgxp::MpPlane_tgxp(int slot, const std::string& flight_id, const std::string& acf_type,
+                           float x, float y, float z, float psi) : slot_(slot)
+{
+    flight_id_ = flight_id;
 
-        //get y for ground level
-        if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
-            log_msg("terrain probe failed???");
-        }
-        y_ = probeinfo.locationY;
+    on_ground_ = true;  // otherwise we were not here
+    parkbrake_set_ = true;
 
-        psi_ = psi;
+    log_cat(kLogMp, "pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), acf_type.c_str());
 
-        log_msg("pid=%d, icao: %s, found door 1 in door_info_map: x: %0.2f, y: %0.2f, z: %0.2f",
-                id_, icao_.c_str(), door_info_[0].x, door_info_[0].y, door_info_[0].z);
-    } catch(const std::out_of_range& ex) {
-        log_msg("pid=%d, %s: door 1 is not defined in door_info_map, deactivating slot", id_, type_code.c_str());
+    const TypeMemo& tm = resolve_acf_type(acf_type);
+    if (!tm.valid) {
+        log_msg("pid=%d, %s: no usable type, deactivating slot", id_, acf_type.c_str());
         state_ = DISABLED;
         return;
     }
 
-    // door 2 +3 are optional
-    try {
-        door_info_[1] = csl_door_info_map.at(icao_ + '2');
-        n_door_++;
-        door_info_[2] = csl_door_info_map.at(icao_ + '3');
-        n_door_++;
-    } catch(const std::out_of_range& ex) {}
+    icao_ = tm.icao;
+    n_door_ = tm.doors->n_door;
+    for (unsigned i = 0; i < n_door_; i++)
+        door_info_[i] = tm.doors->door[i];
+
+    // lateral adjustment
+    constexpr float z_adjust = 1.0f;      // backwards
+    x_ = x + -sinf(D2R * psi) * z_adjust;
+    z_ = z + cosf(D2R * psi) * z_adjust;
+
+    //get y for ground level
+    if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
+        log_msg("terrain probe failed???");
+    }
+    y_ = probeinfo.locationY;
+
+    psi_ = psi;
+
+    log_cat(kLogMp, "pid=%d, icao: %s, found door 1 in door_info_table: x: %0.2f, y: %0.2f, z: %0.2f",
+            id_, icao_.c_str(), door_info_[0].x, door_info_[0].y, door_info_[0].z);
 
     state_ = IDLE;
 }
 
 void
-MpPlane_tgxp::update(bool beacon)
+MpPlane_tgxp::update(const TrafficSnapshot& ts, int i)
 {
     if (state_ == DISABLED)
         return;
 
-    beacon_on_ = beacon;
+    beacon_on_ = ts.beacon[i];
 
-    // Jetways are only dockable if they were rendered once.
-    // As they come in view over time we just retry a docking attempt if the plane is stuck
-    // in CANT_DOCK.
+    // Jetways are only dockable if they were rendered once or localized from sam.xml.
+    // Sceneries come in range of the localization pass over time so we just retry a docking
+    // attempt if the plane is stuck in CANT_DOCK.
     if (!beacon_on_ && state_ == CANT_DOCK && now > state_change_ts_ + 60.0f)
         state_ = PARKED;
 
-    log_msg("MP update: pid=%02d, slot: %02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, state: %s",
+    log_debug("MP update: pid=%02d, slot: %02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, state: %s",
             id_, slot_, icao_.c_str(), flight_id_.c_str(), beacon_on_, parkbrake_set_,
             state_str_[state_]);
 
@@ -209,7 +224,8 @@ MpAdapter_tgxp::MpAdapter_tgxp()
 
 MpAdapter_tgxp::~MpAdapter_tgxp()
 {
-    log_msg("MpAdapter_tgxp destructor");
+    log_msg("MpAdapter_tgxp destructor, type memo: entries: %d, hits: %llu, misses: %llu",
+            (int)type_memo.size(), stat_type_memo_hit, stat_type_memo_miss);
 }
 
 #define LOAD_DR(type, name) { \
@@ -217,8 +233,15 @@ MpAdapter_tgxp::~MpAdapter_tgxp()
     assert(l == n_planes); \
 }
 
-// static
-float MpAdapter_tgxp::update()
+MpPlane *
+MpAdapter_tgxp::create_plane(const TrafficSnapshot& ts, int i)
+{
+    return new MpPlane_tgxp(ts.slot[i], ts.flight_id(i), ts.icao(i),
+                            ts.x[i], ts.y[i], ts.z[i], ts.psi[i]);
+}
+
+float
+MpAdapter_tgxp::fetch(TrafficSnapshot& ts)
 {
     int n_planes = XPLMGetDatavi(flight_phase_dr, NULL, 0, 0);
     log_msg("MpPlane_tgxp drefs #: %d", n_planes);
@@ -262,10 +285,6 @@ float MpAdapter_tgxp::update()
     if (flight_id_len > 0)
         flight_id_ptr[flight_id_len - 1] = '\0';
 
-    std::unordered_map<std::string, bool> dref_planes;
-    dref_planes.reserve(n_planes);
-
-    int spawn_remain = kSpawnPerRun;
     for (int i = 0; i < n_planes; i++) {
         if (flight_id_len <=0 || acf_type_len <= 0) {
             log_msg("ERROR: not enough values in byte arrays");
@@ -289,45 +308,15 @@ float MpAdapter_tgxp::update()
 
         // filter out:
         // FP_Parked for docking, FP_Startup for undocking (=beacon on in openSAM logic)
-        // and close enough
         FlightPhase flight_phase = (FlightPhase)flight_phase_val_[i];
-        if (!(flight_phase == FP_Parked || flight_phase == FP_Startup)
-            || len2f(x_val_[i] - my_plane.x(), z_val_[i] - my_plane.z()) > kMpMaxDist)
+        if (!(flight_phase == FP_Parked || flight_phase == FP_Startup))
             continue;
 
-        // flight_id
-        std::string flight_id{fid_ptr}, acf_type{type_ptr};
-        dref_planes[flight_id] = true;
-
-        try {
-            auto & pr = mp_planes_.at(flight_id);
-            MpPlane_tgxp* mp_plane = static_cast<MpPlane_tgxp*>(pr.get());
-            mp_plane->update(flight_phase == FP_Startup); // we take that as beacon on switch
-        } catch(const std::out_of_range& ex) {
-            if (flight_phase == FP_Parked) {    // new creation only in parked state
-                if (--spawn_remain < 0)
-                    break;
-                mp_planes_.emplace(flight_id,
-                                   new MpPlane_tgxp(i, flight_id, acf_type,
-                                                    x_val_[i], y_val_[i], z_val_[i], psi_val_[i]));
-            }
-        }
-        //log_msg("TGXP: %d, %d, %s, %s %0.2f, %0.2f, %0.2f",
-        //        i, flight_phase, flight_id.c_str(), acf_type.c_str(), x_val_[i], y_val_[i], z_val_[i]);
+        ts.add(TrafficSnapshot::hash(fid_ptr), x_val_[i], y_val_[i], z_val_[i], psi_val_[i],
+               flight_phase == FP_Parked ? TrafficSnapshot::kParked : TrafficSnapshot::kStartup,
+               flight_phase == FP_Startup,  // we take that as beacon on switch
+               false, i, type_ptr, fid_ptr);
     }
 
-    // loop over mp_planes and delete the ones that are no longer in drefs
-    for (auto & mp : mp_planes_) {
-        const std::string& key = mp.first;
-        Plane& plane = *(mp.second);
-
-        try {
-            dref_planes.at(key);
-        } catch(const std::out_of_range& ex) {
-            log_msg("pid=%d not longer exists, deleted", plane.id_);
-            mp_planes_.erase(key);
-        }
-    }
-    log_msg("------------------ MP active planes found: %d -----------------", (int)mp_planes_.size());
     return 2.0f;
 }
@@ -41,9 +41,11 @@ class MpAdapter_tgxp : public MpAdapter {
     static bool probe();        // probe whether xPilot is active
     MpAdapter_tgxp();
 
+    float fetch(TrafficSnapshot& ts) override;
+    MpPlane *create_plane(const TrafficSnapshot& ts, int i) override;
+
   public:
     ~MpAdapter_tgxp();
     const char* personality() const override { return "TGXP"; };
-    float update() override;
 };
 #endif
@@ -34,9 +34,8 @@ static XPLMDataRef
     x_dr, y_dr, z_dr, psi_dr,                   // position
     on_ground_dr, lights_dr, throttle_dr;        // state
 
-class MpPlane_xPilot : public Plane {
+class MpPlane_xPilot : public MpPlane {
     const int slot_;
-    std::string flight_id_;
 
     // parking brake emulation
     float last_move_ts_{0};
@@ -49,10 +48,7 @@ class MpPlane_xPilot : public Plane {
     MpPlane_xPilot(int slot, const std::string& flight_id, const std::string& icao);
     ~MpPlane_xPilot() override {}
 
-    void update(float x, float y, float z, float psi, float throttle, int lights);
-
-    bool auto_mode() const override { return true; }
-    bool dock_requested() override { return true; }
+    void update(const TrafficSnapshot& ts, int i) override;
 };
 
 
@@ -63,36 +59,36 @@ MpPlane_xPilot::MpPlane_xPilot(int slot, const std::string& flight_id, const std
 
     on_ground_ = true;  // otherwise we were not here
 
-    log_msg("pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), icao_.c_str());
+    log_cat(kLogMp, "pid=%d, constructing MpPlane %s/%s", id_, flight_id_.c_str(), icao_.c_str());
 
-    n_door_ = 0;
-    try {
-        door_info_[0] = csl_door_info_map.at(icao_ + '1');
-        n_door_++;
-        log_msg("pid=%d, found door 1 in door_info_map: x: %0.2f, y: %0.2f, z: %0.2f",
-                id_, door_info_[0].x, door_info_[0].y, door_info_[0].z);
-    }
-    catch(const std::out_of_range& ex) {
-        log_msg("pid=%d, %s: door 1 is not defined in door_info_map, deactivating slot", id_, icao_.c_str());
+    const DoorInfoRec *dir = csl_door_info_table.find(icao_);
+    if (dir == nullptr || dir->n_door == 0) {
+        log_msg("pid=%d, %s: door 1 is not defined in door_info_table, deactivating slot", id_, icao_.c_str());
         state_ = DISABLED;
         return;
     }
 
+    // only door 1 for xPilot
+    door_info_[0] = dir->door[0];
+    n_door_ = 1;
+    log_cat(kLogMp, "pid=%d, found door 1 in door_info_table: x: %0.2f, y: %0.2f, z: %0.2f",
+            id_, door_info_[0].x, door_info_[0].y, door_info_[0].z);
+
     state_ = IDLE;
 }
 
 void
-MpPlane_xPilot::update(float x, float y, float z, float psi, float throttle, int lights)
+MpPlane_xPilot::update(const TrafficSnapshot& ts, int i)
 {
     if (state_ == DISABLED)
         return;
 
-    x_ = x;
-    y_ = y;
-    z_ = z;
-    psi_ = psi;
+    x_ = ts.x[i];
+    y_ = ts.y[i];
+    z_ = ts.z[i];
+    psi_ = ts.psi[i];
 
-    engines_on_ = (throttle > 0.1f);
+    engines_on_ = ts.engines_on[i];
 
     // 'parkbrake' detection
     if (fabsf(x_ - x_last_move_) > 0.5f || fabsf(z_ - z_last_move_) > 0.5f) {
@@ -100,10 +96,10 @@ MpPlane_xPilot::update(float x, float y, float z, float psi, float throttle, int
         last_move_ts_ = now;
     }
 
-    beacon_on_ = ((lights & 1) == 1);
+    beacon_on_ = ts.beacon[i];
     parkbrake_set_ = ((now - last_move_ts_) > 10.0f);
 
-    log_msg("MP update: pid=%02d, slot: %02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, engine_on: %d, state: %s",
+    log_debug("MP update: pid=%02d, slot: %02d, icao: %s, id: %s, beacon: %d, parkbrake_set: %d, engine_on: %d, state: %s",
             id_, slot_, icao_.c_str(), flight_id_.c_str(), beacon_on_, parkbrake_set_, engines_on_,
             state_str_[state_]);
 }
@@ -160,8 +156,14 @@ MpAdapter_xPilot::~MpAdapter_xPilot()
 #define LOAD_DR(type, name) \
     XPLMGetDatav ## type ( name ## _dr,  name ## _val_.get(), 0, n_planes_)
 
-// static
-float MpAdapter_xPilot::update()
+MpPlane *
+MpAdapter_xPilot::create_plane(const TrafficSnapshot& ts, int i)
+{
+    return new MpPlane_xPilot(ts.slot[i], ts.flight_id(i), ts.icao(i));
+}
+
+float
+MpAdapter_xPilot::fetch(TrafficSnapshot& ts)
 {
     LOAD_DR(i, modeS_id);
     LOAD_DR(i, on_ground);
@@ -175,52 +177,27 @@ float MpAdapter_xPilot::update()
     XPLMGetDatab(icao_type_dr, icao_type_val_.get(), 0, n_planes_ * 8);
     XPLMGetDatab(flight_id_dr, flight_id_val_.get(), 0, n_planes_ * 8);
 
-    std::unordered_map<std::string, bool> dref_planes;
-    dref_planes.reserve(n_planes_);
-
     for (int i = 1; i < n_planes_; i++) {
-        // slot empty or not on ground or far away -> ignore
-        if (0 == modeS_id_val_[i] || ! on_ground_val_[i]
-            || len2f(x_val_[i] - my_plane.x(), z_val_[i] - my_plane.z()) > kMpMaxDist)
+        // slot empty or not on ground -> ignore
+        if (0 == modeS_id_val_[i] || ! on_ground_val_[i])
             continue;
 
         // flight_id
-        char *cptr = flight_id_val_.get() + i * 8;
-        cptr[7] = '\0';     // play it safe
-        std::string flight_id = cptr;
+        char *flight_id = flight_id_val_.get() + i * 8;
+        flight_id[7] = '\0';     // play it safe
 
         // icao type
-        cptr = icao_type_val_.get() + i * 8;
-        cptr[7] = '\0';     // play it safe
-        std::string icao = cptr;
-
-        std::string key = flight_id + '/' + icao;
-        dref_planes[key] = true;
-
-        try {
-            auto & pr = mp_planes_.at(key);
-            MpPlane_xPilot* mp_plane = static_cast<MpPlane_xPilot*>(pr.get());
-            mp_plane->update(x_val_[i], y_val_[i], z_val_[i], psi_val_[i], throttle_val_[i], lights_val_[i]);
-        } catch(const std::out_of_range& ex) {
-            MpPlane_xPilot* mp_plane = new MpPlane_xPilot(i, flight_id, icao);
-            mp_plane->update(x_val_[i], y_val_[i], z_val_[i], psi_val_[i], throttle_val_[i], lights_val_[i]);
-            mp_planes_.emplace(key, mp_plane);
-        }
-    }
+        char *icao = icao_type_val_.get() + i * 8;
+        icao[7] = '\0';     // play it safe
+
+        char key[16];
+        snprintf(key, sizeof(key), "%s/%s", flight_id, icao);
 
-    // loop over mp_planes_ and delete the ones that are no longer in drefs
-    for (auto & mp : mp_planes_) {
-        const std::string& key = mp.first;
-        Plane& plane = *(mp.second);
-
-        try {
-            dref_planes.at(key);
-        } catch(const std::out_of_range& ex) {
-            log_msg("pid=%d not longer exists, deleted", plane.id_);
-            mp_planes_.erase(key);
-        }
+        // no flight phase available, the plane emulates the parkbrake from movement
+        ts.add(TrafficSnapshot::hash(key), x_val_[i], y_val_[i], z_val_[i], psi_val_[i],
+               TrafficSnapshot::kParked, (lights_val_[i] & 1) == 1, throttle_val_[i] > 0.1f,
+               i, icao, flight_id);
     }
 
-    log_msg("------------------ MP active planes found: %d -----------------", (int)mp_planes_.size());
     return 2.0f;
 }
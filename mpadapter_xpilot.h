@@ -39,9 +39,11 @@ class MpAdapter_xPilot : public MpAdapter {
     static bool probe();        // probe whether xPilot is active
     MpAdapter_xPilot();
 
+    float fetch(TrafficSnapshot& ts) override;
+    MpPlane *create_plane(const TrafficSnapshot& ts, int i) override;
+
   public:
     ~MpAdapter_xPilot();
     const char* personality() const override { return "xPilot"; };
-    float update() override;
 };
 #endif
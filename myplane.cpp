@@ -21,9 +21,25 @@
 */
 
 #include <cstdlib>
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <fstream>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <sys/stat.h>
+
+#if IBM
+// keep windows.h from defining min/max macros that break std::min/std::max
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "openSAM.h"
 #include "XPLMPlanes.h"
@@ -31,6 +47,9 @@
 
 #include "plane.h"
 #include "samjw.h"
+#include "os_dgs.h"
+#include "os_trace.h"
+#include "os_rec.h"
 
 MyPlane my_plane;
 
@@ -98,7 +117,15 @@ static XPLMDataRef plane_x_dr_, plane_y_dr_, plane_z_dr_,
     acf_icao_dr_, acf_cg_y_dr_, acf_cg_z_dr_, acf_gear_z_dr_,
     acf_door_x_dr_, acf_door_y_dr_, acf_door_z_dr_, acf_livery_path_dr_;
 
-static bool find_icao_in_file(const std::string& acf_icao, const std::string& fn);
+// aircraft policies from the acf_*.txt files
+enum AcfPolicy { kUseEngineRunning = 1, kDontConnectJetway = 2 };
+
+// a line matches if it starts with the icao, so the key is the line's first 4 chars
+static std::unordered_map<std::string, unsigned> acf_policy;
+
+// livery.tlscfg path -> door config is CLASSIC
+static std::unordered_map<std::string, bool> livery_classic_cache;
+static bool acf_door2(const char *acf_path, float& x, float& y, float& z);
 
 MyPlane::MyPlane()
 {
@@ -177,6 +204,21 @@ MyPlane::toggle_requested()
     return res;
 }
 
+unsigned
+MyPlane::requests() const
+{
+    return (dock_requested_ ? kRecReqDock : 0) | (undock_requested_ ? kRecReqUndock : 0)
+           | (toggle_requested_ ? kRecReqToggle : 0);
+}
+
+void
+MyPlane::set_requests(unsigned req)
+{
+    dock_requested_ = req & kRecReqDock;
+    undock_requested_ = req & kRecReqUndock;
+    toggle_requested_ = req & kRecReqToggle;
+}
+
 void
 MyPlane::auto_mode_set(bool auto_mode)
 {
@@ -207,6 +249,7 @@ MyPlane::plane_loaded()
 {
     on_ground_ = 1;
     on_ground_ts_ = 0.0f;
+    std::fill(smpl_.next_ts, smpl_.next_ts + kSmplNum, 0.0f);   // resample all
 
     icao_.resize(4);
     XPLMGetDatab(acf_icao_dr_, icao_.data(), 0, 4);
@@ -234,17 +277,7 @@ MyPlane::plane_loaded()
     if (is_helicopter_)
         return;
 
-    // check whether acf is listed in exception files
-    std::string line; line.reserve(200);
-    if (find_icao_in_file(icao_, base_dir + "acf_use_engine_running.txt")) {
-        use_engines_on_ = true;
-        log_msg("found");
-    }
-
-    if (find_icao_in_file(icao_, base_dir + "acf_dont_connect_jetway.txt")) {
-        dont_connect_jetway_ = true;
-        log_msg("found");
-    }
+    apply_acf_policy();
 
     door_info_[0].x = XPLMGetDataf(acf_door_x_dr_);
     door_info_[0].y = XPLMGetDataf(acf_door_y_dr_);
@@ -259,15 +292,14 @@ MyPlane::plane_loaded()
 
     // check for a second door, seems to be not available by dataref
     // data in the acf file is often bogus, so check our own config file first
-    try {
-        door_info_[1] = door_info_map.at(icao_ + '2');
+    const DoorInfoRec *dir = door_info_table.find(icao_);
+    if (dir && dir->has_door(2)) {
+        door_info_[1] = dir->door[1];
         n_door_++;
-        log_msg("found door 2 in door_info_map: x: %0.2f, y: %0.2f, z: %0.2f",
+        log_msg("found door 2 in door_info_table: x: %0.2f, y: %0.2f, z: %0.2f",
                 door_info_[1].x, door_info_[1].y, door_info_[1].z);
-    }
-    catch(const std::out_of_range& ex) {
-        log_msg("door 2 is not defined in door_info_map");
-    }
+    } else
+        log_msg("door 2 is not defined in door_info_table");
 
     // if nothing found in the config file try the acf
     if (n_door_ == 1) {
@@ -277,48 +309,14 @@ MyPlane::plane_loaded()
         XPLMGetNthAircraftModel(XPLM_USER_AIRCRAFT, acf_file, acf_path);
         log_msg("acf path: '%s'", acf_path);
 
-        FILE *acf = fopen(acf_path, "r");
-        if (acf) {
-            char line[200];
-            int got = 0;
-            int has_door2 = 0;
-            // we go the simple brute force way
-            while (fgets(line, sizeof(line), acf)) {
-                if (line == strstr(line, "P acf/_has_board_2 ")) {
-                    if (1 != sscanf(line + 19, "%d", &has_door2))
-                    break;
-                }
-
-                if (line == strstr(line, "P acf/_board_2/0 ")) {
-                    if (1 == sscanf(line + 17, "%f", &door_info_[1].x)) {
-                        door_info_[1].x *= F2M;
-                        got++;
-                    }
-                }
-                if (line == strstr(line, "P acf/_board_2/1 ")) {
-                    float y;
-                    if (1 == sscanf(line + 17, "%f", &y)) {
-                        door_info_[1].y = y * F2M - plane_cg_y;
-                        got++;
-                    }
-                }
-                if (line == strstr(line, "P acf/_board_2/2 ")) {
-                    float z;
-                    if (1 == sscanf(line + 17, "%f", &z)) {
-                        door_info_[1].z = z * F2M - plane_cg_z;
-                        got++;
-                    }
-                }
-
-                if (has_door2 && got == 3) {
-                    n_door_ = 2;
-                    log_msg("found door 2 in acf file: x: %0.2f, y: %0.2f, z: %0.2f",
-                            door_info_[1].x, door_info_[1].y, door_info_[1].z);
-                    break;
-                }
-            }
-
-            fclose(acf);
+        float x, y, z;
+        if (acf_door2(acf_path, x, y, z)) {
+            door_info_[1].x = x * F2M;
+            door_info_[1].y = y * F2M - plane_cg_y;
+            door_info_[1].z = z * F2M - plane_cg_z;
+            n_door_ = 2;
+            log_msg("found door 2 in acf file: x: %0.2f, y: %0.2f, z: %0.2f",
+                    door_info_[1].x, door_info_[1].y, door_info_[1].z);
         }
     }
 
@@ -345,46 +343,156 @@ void MyPlane::livery_loaded()
     strcat(path, "livery.tlscfg");
     log_msg("tlscfg path: '%s'", path);
 
-    FILE *f = fopen(path, "r");
-    if (f) {
-        char line[150];
-        line[sizeof(line) - 1] = '\0';
-        while (fgets(line, sizeof(line) - 1, f)) {
-            if (NULL != strstr(line, "exit_Configuration")) {
-                if (NULL == strstr(line, "CLASSIC")) {
-                    log_msg("door != CLASSIC, setting n_door to 1");
-                    n_door_ = 1;
+    bool classic = true;    // no file = default config
+    auto it = livery_classic_cache.find(path);
+    if (it != livery_classic_cache.end())
+        classic = it->second;
+    else {
+        FILE *f = fopen(path, "r");
+        if (f) {
+            char line[150];
+            line[sizeof(line) - 1] = '\0';
+            while (fgets(line, sizeof(line) - 1, f)) {
+                if (NULL != strstr(line, "exit_Configuration")) {
+                    classic = (NULL != strstr(line, "CLASSIC"));
+                    break;
                 }
-                break;
             }
+
+            fclose(f);
         }
 
-        fclose(f);
+        livery_classic_cache[path] = classic;
+    }
+
+    if (!classic) {
+        log_msg("door != CLASSIC, setting n_door to 1");
+        n_door_ = 1;
+    }
+}
+
+// sampling period (s) of a field, 0 = every update()
+float
+MyPlane::sample_period(SampleField f) const
+{
+    bool dgs_busy = dgs_tracking();
+    bool jw_busy = this->jw_busy();
+
+    switch (f) {
+        case kSmplPos:
+            return 0.0f;
+
+        case kSmplGear:
+            return 0.5f;    // transitions are debounced by 10 s anyway
+
+        case kSmplEngines:
+            if (!use_engines_on_)
+                return 5.0f;    // informational only
+            [[fallthrough]];
+
+        case kSmplBeacon:   // debounced by 3 s
+            if (dgs_busy)
+                return 0.25f;
+            return (on_ground_ && (jw_busy || state_ == IDLE)) ? 0.5f : 2.0f;
+
+        case kSmplParkbrake:    // only used by the DGS
+            return dgs_busy ? 0.1f : 2.0f;
+
+        case kSmplElevation:    // for stand coordinates, resampled on ref_gen change
+            return on_ground_ ? 1.0f : 5.0f;
+
+        default:
+            return 0.0f;
     }
 }
 
+bool
+MyPlane::sample_due(SampleField f)
+{
+    if (now < smpl_.next_ts[f])
+        return false;
+
+    smpl_.next_ts[f] = now + sample_period(f);
+    return true;
+}
+
 void
 MyPlane::update()
 {
-    x_ = XPLMGetDataf(plane_x_dr_);
-    y_ = XPLMGetDataf(plane_y_dr_);
-    z_ = XPLMGetDataf(plane_z_dr_);
-    psi_=XPLMGetDataf(plane_true_psi_dr_);
+    TRACE_SCOPE("MyPlane::update");
+    stat_my_update++;
+    if (smpl_ts0_ < 0.0f)
+        smpl_ts0_ = now;
+
+    // When the DGS starts tracking or the jetway states are entered the slow
+    // fields may be one slow period old. Resample them now.
+    bool busy = dgs_tracking() || jw_busy();
+    if (busy && !smpl_busy_)
+        for (int i = kSmplGear; i < kSmplNum; i++)
+            smpl_.next_ts[i] = 0.0f;
+    smpl_busy_ = busy;
+
+    if (sample_due(kSmplPos)) {
+        smpl_.x = XPLMGetDataf(plane_x_dr_);
+        smpl_.y = XPLMGetDataf(plane_y_dr_);
+        smpl_.z = XPLMGetDataf(plane_z_dr_);
+        smpl_.psi = XPLMGetDataf(plane_true_psi_dr_);
+        stat_my_dr_read += 4;
+    }
+
+    if (sample_due(kSmplGear)) {
+        smpl_.gear_fnrml = XPLMGetDataf(gear_fnrml_dr_);
+        stat_my_dr_read++;
+    }
+
+    if (sample_due(kSmplEngines)) {
+        smpl_.n_eng = XPLMGetDatavi(eng_running_dr_, smpl_.eng_running, 0, 8);
+        stat_my_dr_read++;
+    }
+
+    if (!use_engines_on_ && sample_due(kSmplBeacon)) {
+        smpl_.beacon = XPLMGetDatai(beacon_dr_);
+        stat_my_dr_read++;
+    }
+
+    if (sample_due(kSmplParkbrake)) {
+        smpl_.parkbrake = XPLMGetDataf(parkbrake_dr_);
+        stat_my_dr_read++;
+    }
+
+    if (smpl_ref_gen_ != ::ref_gen) {     // local coordinates changed
+        smpl_ref_gen_ = ::ref_gen;
+        smpl_.next_ts[kSmplElevation] = 0.0f;
+    }
+
+    if (sample_due(kSmplElevation)) {
+        smpl_.elevation = XPLMGetDataf(plane_elevation_dr_);
+        stat_my_dr_read++;
+    }
+
+    x_ = smpl_.x;
+    y_ = smpl_.y;
+    z_ = smpl_.z;
+    psi_= smpl_.psi;
 
     // on ground detection
-    int og = (XPLMGetDataf(gear_fnrml_dr_) != 0.0);
+    int og = (smpl_.gear_fnrml != 0.0);
     if (og != on_ground_ && now > on_ground_ts_ + 10.0f) {
         on_ground_ = og;
         on_ground_ts_ = now;
         log_msg("transition to on_ground: %d", on_ground_);
+
+        // dgs_set_active() needs a current elevation, other rates change
+        smpl_.elevation = XPLMGetDataf(plane_elevation_dr_);
+        stat_my_dr_read++;
+        for (int i = kSmplGear; i < kSmplNum; i++)
+            smpl_.next_ts[i] = std::min(smpl_.next_ts[i], now + sample_period((SampleField)i));
     }
 
     // engines on
     engines_on_ = false;
-    int er[8];
-    int n = XPLMGetDatavi(eng_running_dr_, er, 0, 8);
-    for (int i = 0; i < n; i++)
-        if (er[i]) {
+    for (int i = 0; i < smpl_.n_eng; i++)
+        if (smpl_.eng_running[i]) {
             engines_on_ = true;
             break;
         }
@@ -397,8 +505,7 @@ MyPlane::update()
         // to the APU generator (e.g. for the ToLiss fleet).
         // Report only state transitions when the new state persisted for 3 seconds
 
-        int beacon = XPLMGetDatai(beacon_dr_);
-        if (beacon) {
+        if (smpl_.beacon) {
             if (! beacon_on_pending_) {
                 beacon_on_ts_ = ::now;
                 beacon_on_pending_ = true;
@@ -413,8 +520,18 @@ MyPlane::update()
        }
     }
 
-    parkbrake_set_ = (XPLMGetDataf(parkbrake_dr_) > 0.5f);
-    elevation_ = XPLMGetDataf(plane_elevation_dr_);
+    parkbrake_set_ = (smpl_.parkbrake > 0.5f);
+    elevation_ = smpl_.elevation;
+}
+
+void
+MyPlane::log_sample_stats() const
+{
+    // the unbatched update() read 9 drefs per call
+    float dt = std::max(now - smpl_ts0_, 1.0f);
+    log_msg("my_plane updates:         %llu, dref reads: %llu (%0.1f/s), unbatched: %llu (%0.1f/s)",
+            stat_my_update, stat_my_dr_read, stat_my_dr_read / dt,
+            9 * stat_my_update, 9 * stat_my_update / dt);
 }
 
 void
@@ -481,25 +598,309 @@ MyPlane::init()
     init_done = true;
 }
 
-static bool
-find_icao_in_file(const std::string& acf_icao, const std::string& fn)
+static void
+load_acf_policy_file(const std::string& fn, unsigned flag)
 {
     std::ifstream f(fn);
-    if (f.is_open()) {
-        log_msg("check whether acf '%s' is in file %s", acf_icao.c_str(), fn.c_str());
-
-        std::string line;
-        while (std::getline(f, line)) {
-            size_t i = line.find('\r');
-            if (i != std::string::npos)
-                line.resize(i);
-
-            if (line.find(acf_icao) == 0) {
-                log_msg("found acf %s in %s", acf_icao.c_str(), fn.c_str());
-                return true;
-           }
+    if (!f.is_open())
+        return;
+
+    // key is the first token of a line, icao codes have 2 to 4 chars
+    std::string line;
+    while (std::getline(f, line)) {
+        size_t b = line.find_first_not_of(" \t\r");
+        if (b == std::string::npos || line[b] == '#')
+            continue;
+
+        size_t e = line.find_first_of(" \t\r", b);
+        acf_policy[line.substr(b, e == std::string::npos ? e : e - b)] |= flag;
+    }
+}
+
+// static, load all policy files, can be called again for a reload
+void
+MyPlane::load_acf_policy()
+{
+    acf_policy.clear();
+    livery_classic_cache.clear();
+
+    load_acf_policy_file(base_dir + "acf_use_engine_running.txt", kUseEngineRunning);
+    load_acf_policy_file(base_dir + "acf_dont_connect_jetway.txt", kDontConnectJetway);
+    log_msg("%d acf policy entries loaded", (int)acf_policy.size());
+}
+
+void
+MyPlane::apply_acf_policy()
+{
+    use_engines_on_ = dont_connect_jetway_ = false;
+    if (is_helicopter_)
+        return;
+
+    // icao_ is blank padded to 4 chars
+    auto it = acf_policy.find(icao_.substr(0, icao_.find_last_not_of(' ') + 1));
+    if (it == acf_policy.end())
+        return;
+
+    use_engines_on_ = it->second & kUseEngineRunning;
+    dont_connect_jetway_ = it->second & kDontConnectJetway;
+    log_msg("acf policy for %s: use_engines_on: %d, dont_connect_jetway: %d",
+            icao_.c_str(), use_engines_on_, dont_connect_jetway_);
+}
+
+//
+// door 2 from the acf file
+//
+// Modern acf files are many MB so we map the file and search for the keys.
+// Results are cached persistently keyed by acf path, size and mtime.
+//
+
+// read only memory mapping of a whole file
+class MappedFile {
+    const char *data_{nullptr};
+    size_t size_{0};
+#if IBM
+    HANDLE fh_{INVALID_HANDLE_VALUE}, mh_{NULL};
+#endif
+
+  public:
+    MappedFile(const char *path);
+    ~MappedFile();
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+};
+
+#if IBM
+MappedFile::MappedFile(const char *path)
+{
+    fh_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                      FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fh_ == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(fh_, &sz) || sz.QuadPart == 0)
+        return;
+
+    mh_ = CreateFileMappingA(fh_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mh_ == NULL)
+        return;
+
+    data_ = (const char *)MapViewOfFile(mh_, FILE_MAP_READ, 0, 0, 0);
+    if (data_)
+        size_ = sz.QuadPart;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mh_ != NULL)
+        CloseHandle(mh_);
+    if (fh_ != INVALID_HANDLE_VALUE)
+        CloseHandle(fh_);
+}
+#else
+MappedFile::MappedFile(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, st.st_size, MADV_SEQUENTIAL);
+            data_ = (const char *)p;
+            size_ = st.st_size;
         }
     }
 
-    return false;
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        munmap((void *)data_, size_);
+}
+#endif
+
+// find key at the beginning of a line
+static const char *
+find_line_key(const char *begin, const char *end, const std::string_view& key)
+{
+    std::boyer_moore_horspool_searcher searcher(key.begin(), key.end());
+
+    const char *p = begin;
+    while (true) {
+        p = std::search(p, end, searcher);
+        if (p == end)
+            return nullptr;
+        if (p == begin || p[-1] == '\n')
+            return p;
+        p++;
+    }
+}
+
+// value of the key's line, at most 40 chars
+static bool
+line_value(const char *p, const char *end, float& val)
+{
+    char buf[41];
+    int i;
+    for (i = 0; i < 40 && p + i < end && p[i] != '\n'; i++)
+        buf[i] = p[i];
+    buf[i] = '\0';
+    return (1 == sscanf(buf, "%f", &val));
+}
+
+// scan acf file, values are in acf units
+static bool
+scan_acf_door2(const char *acf_path, bool& has_door2, float& x, float& y, float& z)
+{
+    MappedFile mf(acf_path);
+    if (mf.data() == nullptr)
+        return false;
+
+    const char *begin = mf.data();
+    const char *end = begin + mf.size();
+    has_door2 = false;
+
+    // alphabetically "_board_2/" comes before "_has_board_2"
+    static const std::string_view board2_key{"P acf/_board_2/"};
+    static const std::string_view has_board2_key{"P acf/_has_board_2 "};
+
+    int got = 0;
+    float *val[3] = {&x, &y, &z};
+    const char *p = begin;
+    while (got < 3 && (p = find_line_key(p, end, board2_key))) {
+        p += board2_key.size();
+        if (p + 2 < end && p[1] == ' ' && BETWEEN(p[0], '0', '2')
+            && line_value(p + 2, end, *val[p[0] - '0']))
+            got++;
+    }
+
+    const char *h = find_line_key(p ? p : begin, end, has_board2_key);
+    if (h == nullptr)   // not sorted as expected, try from the beginning
+        h = find_line_key(begin, end, has_board2_key);
+
+    float hv;
+    if (h && line_value(h + has_board2_key.size(), end, hv))
+        has_door2 = (hv != 0.0f && got == 3);
+
+    return true;
+}
+
+struct AcfDoor2 {
+    long long size, mtime;  // of the acf file
+    bool has_door2;
+    float x, y, z;          // acf units
+};
+
+static std::unordered_map<std::string, AcfDoor2> acf_door2_cache;
+static bool acf_door2_cache_loaded;
+
+static std::string
+acf_door2_cache_fn()
+{
+    return pref_dir + "/openSAM_acf_door2.cache";
+}
+
+static void
+write_acf_door2_entry(FILE *f, const std::string& path, const AcfDoor2& ad)
+{
+    fprintf(f, "%lld %lld %d %.9g %.9g %.9g %s\n", ad.size, ad.mtime, ad.has_door2,
+            ad.x, ad.y, ad.z, path.c_str());
+}
+
+// rewrite the whole cache file
+static void
+save_acf_door2_cache()
+{
+    FILE *f = fopen(acf_door2_cache_fn().c_str(), "w");
+    if (f == nullptr) {
+        log_msg("can't write acf door 2 cache");
+        return;
+    }
+
+    for (auto & e : acf_door2_cache)
+        write_acf_door2_entry(f, e.first, e.second);
+
+    fclose(f);
+}
+
+// line format: size mtime has_door2 x y z path
+// New entries are appended so a later line for the same path wins.
+static void
+load_acf_door2_cache()
+{
+    acf_door2_cache_loaded = true;
+    std::ifstream f(acf_door2_cache_fn());
+    if (!f.is_open())
+        return;
+
+    int n_lines = 0;
+    std::string line;
+    while (std::getline(f, line)) {
+        AcfDoor2 ad;
+        int has_door2, n;
+        if (6 == sscanf(line.c_str(), "%lld %lld %d %f %f %f %n",
+                        &ad.size, &ad.mtime, &has_door2, &ad.x, &ad.y, &ad.z, &n)
+            && n < (int)line.size()) {
+            ad.has_door2 = has_door2;
+            acf_door2_cache[line.substr(n)] = ad;
+            n_lines++;
+        }
+    }
+
+    f.close();
+    log_msg("%d entries loaded from acf door 2 cache", (int)acf_door2_cache.size());
+
+    // drop outdated entries once they make up half of the file
+    if (n_lines >= 2 * (int)acf_door2_cache.size() + 10)
+        save_acf_door2_cache();
+}
+
+static void
+append_acf_door2_cache(const std::string& path, const AcfDoor2& ad)
+{
+    FILE *f = fopen(acf_door2_cache_fn().c_str(), "a");
+    if (f == nullptr) {
+        log_msg("can't write acf door 2 cache");
+        return;
+    }
+
+    write_acf_door2_entry(f, path, ad);
+    fclose(f);
+}
+
+// get door 2 in acf units from cache or acf file
+static bool
+acf_door2(const char *acf_path, float& x, float& y, float& z)
+{
+    if (!acf_door2_cache_loaded)
+        load_acf_door2_cache();
+
+    struct stat st;
+    if (stat(acf_path, &st) != 0)
+        return false;
+
+    auto it = acf_door2_cache.find(acf_path);
+    if (it == acf_door2_cache.end()
+        || it->second.size != (long long)st.st_size || it->second.mtime != (long long)st.st_mtime) {
+        AcfDoor2 ad{(long long)st.st_size, (long long)st.st_mtime, false, 0.0f, 0.0f, 0.0f};
+        if (!scan_acf_door2(acf_path, ad.has_door2, ad.x, ad.y, ad.z))
+            return false;
+
+        log_msg("scanned acf file, has door 2: %d", ad.has_door2);
+        it = acf_door2_cache.insert_or_assign(acf_path, ad).first;
+        append_acf_door2_cache(it->first, ad);
+    } else
+        log_msg("acf door 2 from cache, has door 2: %d", it->second.has_door2);
+
+    const AcfDoor2& ad = it->second;
+    x = ad.x; y = ad.y; z = ad.z;
+    return ad.has_door2;
 }
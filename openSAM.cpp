@@ -25,6 +25,7 @@
 #include <cstring>
 #include <cmath>
 #include <fstream>
+#include <chrono>
 
 #include "openSAM.h"
 #include "plane.h"
@@ -32,6 +33,9 @@
 #include "samjw.h"
 #include "jwctrl.h"
 #include "os_anim.h"
+#include "os_stats.h"
+#include "os_trace.h"
+#include "os_rec.h"
 #include "plane.h"
 #include "mpadapter.h"
 
@@ -91,6 +95,7 @@ constexpr float kMultiPlayerHeightLimit = 1000.0f;
 
 static int init_fail;
 std::string xp_dir;
+std::string pref_dir;   // X-Plane's preferences directory
 static std::string pref_path;
 static XPLMMenuID os_menu, seasons_menu;
 static int toggle_mp_item, auto_item, season_item[4];
@@ -123,13 +128,24 @@ std::string base_dir; // base directory of openSAM
 
 static std::unique_ptr<MpAdapter> mp_adapter;
 
-std::unordered_map<std::string, DoorInfo> door_info_map;
-std::unordered_map<std::string, DoorInfo> csl_door_info_map;
+bool perf_ui_active;
+double perf_loop_us;
+
+void
+mp_state_counts(unsigned *counts)
+{
+    if (mp_adapter)
+        mp_adapter->state_counts(counts);
+}
+
+DoorInfoTable door_info_table, csl_door_info_table;
 std::unordered_map<std::string, std::string> acf_generic_type_map;
 
 unsigned long long stat_sc_far_skip, stat_far_skip, stat_near_skip,
     stat_acc_called, stat_jw_match, stat_dgs_acc, stat_dgs_acc_last,
-    stat_anim_acc_called, stat_auto_drf_called;
+    stat_anim_acc_called, stat_auto_drf_called, stat_jw_localized,
+    stat_type_memo_hit, stat_type_memo_miss,
+    stat_my_update, stat_my_dr_read;
 
 XPLMProbeInfo_t probeinfo;
 XPLMProbeRef probe_ref;
@@ -202,6 +218,7 @@ cmd_activate_cb([[maybe_unused]] XPLMCommandRef cmdr,
     if (xplm_CommandBegin != phase)
         return 0;
 
+    REC_EVENT(kRecEvActivate, 0);
     log_msg("cmd manually_activate");
     dgs_set_active();
     return 0;
@@ -219,6 +236,31 @@ cmd_toggle_ui_cb([[maybe_unused]] XPLMCommandRef cmdr,
     return 0;
 }
 
+static int
+cmd_toggle_perf_ui_cb([[maybe_unused]] XPLMCommandRef cmdr,
+                      XPLMCommandPhase phase, [[maybe_unused]] void *ref)
+{
+    if (xplm_CommandBegin != phase)
+        return 0;
+
+    log_msg("cmd toggle_perf_ui");
+    toggle_perf_ui();
+    return 0;
+}
+
+static int
+cmd_reload_acf_policy_cb([[maybe_unused]] XPLMCommandRef cmdr,
+                         XPLMCommandPhase phase, [[maybe_unused]] void *ref)
+{
+    if (xplm_CommandBegin != phase)
+        return 0;
+
+    log_msg("cmd reload_acf_policy");
+    MyPlane::load_acf_policy();
+    my_plane.apply_acf_policy();
+    return 0;
+}
+
 // multiplayer activation
 static int
 cmd_toggle_mp_cb([[maybe_unused]]XPLMCommandRef cmdr,
@@ -227,6 +269,7 @@ cmd_toggle_mp_cb([[maybe_unused]]XPLMCommandRef cmdr,
     if (xplm_CommandBegin != phase)
         return 0;
 
+    REC_EVENT(kRecEvToggleMp, 0);
     log_msg("cmd toggle_mp");
     if (mp_adapter) {
         mp_adapter = nullptr;
@@ -253,9 +296,19 @@ flight_loop_cb([[maybe_unused]] float inElapsedSinceLastCall,
                [[maybe_unused]] float inElapsedTimeSinceLastFlightLoop, [[maybe_unused]] int inCounter,
                [[maybe_unused]] void *inRefcon)
 {
-    static float jw_next_ts, dgs_next_ts, anim_next_ts, mp_update_next_ts;
+    static float jw_next_ts, dgs_next_ts, anim_next_ts, mp_update_next_ts, jw_loc_next_ts;
+
+    ALLOC_SCOPE(kAllocFlightLoop);
+    ALLOC_LOOP_SCOPE();
+    REC_LOOP(mp_adapter != nullptr);
 
+    std::chrono::steady_clock::time_point perf_t0;
+    if (perf_ui_active)
+        perf_t0 = std::chrono::steady_clock::now();
+
+    log_flush();    // what was logged since the last call
     now = XPLMGetDataf(total_running_time_sec_dr);
+    stats_update();
 
     bool on_ground_prev = my_plane.on_ground();
     my_plane.update();
@@ -275,14 +328,23 @@ flight_loop_cb([[maybe_unused]] float inElapsedSinceLastCall,
     float mp_update_delay = mp_update_next_ts - now;
 
     float my_y_agl = my_plane.y_agl();
-    if (my_y_agl < kMultiPlayerHeightLimit
-        && mp_adapter && mp_update_delay <= 0.0f)
-        mp_update_next_ts = now + mp_adapter->update();
+    bool mp_active = (my_y_agl < kMultiPlayerHeightLimit && mp_adapter);
+    if (mp_active && mp_update_delay <= 0.0f) {
+        mp_update_delay = mp_adapter->update();     // < 0 while spawning
+        mp_update_next_ts = now + mp_update_delay;
+    }
+
+    // make jetways dockable for MP planes before they are drawn
+    float jw_loc_delay = jw_loc_next_ts - now;
+    if (mp_active && jw_loc_delay <= 0.0f) {
+        jw_loc_delay = jw_localize_pass();          // < 0 while localizing
+        jw_loc_next_ts = now + jw_loc_delay;
+    }
 
     if (! my_plane.is_helicopter_) {
         if (jw_loop_delay <= 0.0f) {
             jw_loop_delay = my_plane.jw_state_machine();
-            if (my_y_agl < kMultiPlayerHeightLimit && mp_adapter)
+            if (mp_active)
                 jw_loop_delay = std::min(jw_loop_delay,
                                          mp_adapter->jw_state_machine());
 
@@ -301,7 +363,13 @@ flight_loop_cb([[maybe_unused]] float inElapsedSinceLastCall,
         anim_next_ts = now + anim_loop_delay;
     }
     //log_msg("jw_loop_delay: %0.2f", jw_loop_delay);
-    return std::min(anim_loop_delay, std::min(jw_loop_delay, dgs_loop_delay));
+    float loop_delay = std::min(anim_loop_delay, std::min(jw_loop_delay, dgs_loop_delay));
+    if (mp_active)
+        loop_delay = std::min(loop_delay, std::min(mp_update_delay, jw_loc_delay));
+
+    if (perf_ui_active)
+        perf_loop_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - perf_t0).count();
+    return loop_delay;
 }
 
 // set season according to date
@@ -404,14 +472,86 @@ cmd_xp12_dock_jw_cb([[maybe_unused]] XPLMCommandRef cmdr, XPLMCommandPhase phase
     return 1;       // pass on to XP12, likely there is no XP12 jw here 8-)
 }
 
+//==============  DoorInfoTable ========================================
+uint32_t
+DoorInfoTable::pack(const char *icao)
+{
+    uint32_t key = 0;
+    for (int i = 0; i < 4; i++) {
+        if (icao[i] == '\0')
+            return key;
+        key |= (uint32_t)(uint8_t)icao[i] << (8 * i);
+    }
+
+    return icao[4] == '\0' ? key : 0;
+}
+
+// return slot with the key or the empty slot where it belongs
+DoorInfoRec *
+DoorInfoTable::probe(uint32_t key)
+{
+    unsigned m = slots_.size() - 1;
+    for (unsigned i = (key * 2654435761u) & m; ; i = (i + 1) & m) {
+        DoorInfoRec& r = slots_[i];
+        if (r.icao == key || r.icao == 0)
+            return &r;
+    }
+}
+
+void
+DoorInfoTable::grow()
+{
+    std::vector<DoorInfoRec> old;
+    old.swap(slots_);
+    slots_.resize(old.empty() ? 64 : 2 * old.size(), DoorInfoRec{});
+    for (auto & r : old)
+        if (r.icao)
+            *probe(r.icao) = r;
+}
+
+void
+DoorInfoTable::set(const char *icao, int d, const DoorInfo& di)
+{
+    uint32_t key = pack(icao);
+    if (key == 0 || d < 1 || d > kMaxDoor)
+        return;
+
+    // keep load factor <= 0.5
+    if (2 * (n_ + 1) > slots_.size())
+        grow();
+
+    DoorInfoRec *r = probe(key);
+    if (r->icao == 0) {
+        r->icao = key;
+        n_++;
+    }
+
+    r->door[d - 1] = di;
+    r->mask |= 1 << (d - 1);
+    r->n_door = 0;
+    while (r->n_door < kMaxDoor && r->has_door(r->n_door + 1))
+        r->n_door++;
+}
+
+const DoorInfoRec *
+DoorInfoTable::find(const std::string& icao) const
+{
+    uint32_t key = pack(icao);
+    if (key == 0 || n_ == 0)
+        return nullptr;
+
+    const DoorInfoRec *r = const_cast<DoorInfoTable*>(this)->probe(key);
+    return r->icao ? r : nullptr;
+}
+
 static void
-load_door_info(const std::string& fn, std::unordered_map<std::string, DoorInfo>& di_map)
+load_door_info(const std::string& fn, DoorInfoTable& di_table)
 {
     std::ifstream f(fn);
     if (!f.is_open())
         throw OsEx("Error loading " + fn);
 
-    log_msg("Building door_info_map from %s",  fn.c_str());
+    log_msg("Building door info table from %s",  fn.c_str());
 
     std::string line;
     while (std::getline(f, line)) {
@@ -431,13 +571,11 @@ load_door_info(const std::string& fn, std::unordered_map<std::string, DoorInfo>&
                 continue;
             }
 
-            char c = d + '0';
-            DoorInfo d{x, y, z};
-            di_map[std::string(icao) + c] = d;
+            di_table.set(icao, d, DoorInfo{x, y, z});
         }
     }
 
-    log_msg("%d mappings loaded", (int)di_map.size());
+    log_msg("%d types loaded", (int)di_table.size());
 }
 
 static void
@@ -490,17 +628,26 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
     // set pref path
     XPLMGetPrefsPath(buffer);
     XPLMExtractFileAndPath(buffer);
-    pref_path = std::string(buffer) + "/openSAM.prf";
+    pref_dir = std::string(buffer);
+    pref_path = pref_dir + "/openSAM.prf";
 
     // set plugin's base dir
     base_dir = xp_dir + "Resources/plugins/openSAM/";
+    log_load_config(base_dir + "log_config.txt");
+
+    if (getenv("OPENSAM_TRACE"))    // trace from the very beginning
+        trace_start();
 
     // collect all config and *.xml files
     try {
-        load_door_info(base_dir + "acf_door_position.txt", door_info_map);
-        load_door_info(base_dir + "csl_door_position.txt", csl_door_info_map);
-        load_acf_generic_type(base_dir + "acf_generic_type.txt");
+        {
+            TRACE_SCOPE("load_door_info");
+            load_door_info(base_dir + "acf_door_position.txt", door_info_table);
+            load_door_info(base_dir + "csl_door_position.txt", csl_door_info_table);
+            load_acf_generic_type(base_dir + "acf_generic_type.txt");
+        }
 
+        TRACE_SCOPE("collect_sam_xml");
         SceneryPacks scp(xp_dir);
         sam_library_installed = scp.SAM_Library_path.size() > 0;
         collect_sam_xml(scp);
@@ -546,7 +693,11 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
                                  NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
                                  NULL, NULL, NULL, (void *)(long long)i, NULL);
 
+    stats_init();
+    trace_init();
+
     MyPlane::init();
+    MyPlane::load_acf_policy();
     my_plane.auto_mode_set(pref_auto_mode);
     jw_init();
     JwCtrl::init();
@@ -560,6 +711,9 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
     XPLMCommandRef toggle_ui_cmdr = XPLMCreateCommand("openSAM/toggle_ui", "Toggle UI");
     XPLMRegisterCommandHandler(toggle_ui_cmdr, cmd_toggle_ui_cb, 0, NULL);
 
+    XPLMCommandRef toggle_perf_ui_cmdr = XPLMCreateCommand("openSAM/toggle_perf_ui", "Toggle performance dashboard");
+    XPLMRegisterCommandHandler(toggle_perf_ui_cmdr, cmd_toggle_perf_ui_cb, 0, NULL);
+
     XPLMCommandRef dock_cmdr = XPLMCreateCommand("openSAM/dock_jwy", "Dock jetway");
     XPLMRegisterCommandHandler(dock_cmdr, cmd_dock_jw_cb, 0, (void *)0);
 
@@ -572,6 +726,10 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
     XPLMCommandRef toggle_mp_cmdr = XPLMCreateCommand("openSAM/toggle_multiplayer", "Toggle Multiplayer Support");
     XPLMRegisterCommandHandler(toggle_mp_cmdr, cmd_toggle_mp_cb, 0, NULL);
 
+    XPLMCommandRef reload_acf_policy_cmdr = XPLMCreateCommand("openSAM/reload_acf_policy",
+                                                              "Reload aircraft exception files");
+    XPLMRegisterCommandHandler(reload_acf_policy_cmdr, cmd_reload_acf_policy_cb, 0, NULL);
+
     // augment XP12's standard cmd
     XPLMCommandRef xp12_toggle_cmdr = XPLMFindCommand("sim/ground_ops/jetway");
     if (xp12_toggle_cmdr)
@@ -619,6 +777,7 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
     set_menu();
 
     // ... and off we go
+    rec_open();
     XPLMRegisterFlightLoopCallback(flight_loop_cb, 2.0, NULL);
     return 1;
 
@@ -635,14 +794,18 @@ XPluginStart(char *out_name, char *out_sig, char *out_desc)
 PLUGIN_API void
 XPluginStop(void)
 {
+    // the recording covers the whole session including disable/enable cycles
+    rec_close();
+
+    if (probe_ref)
+        XPLMDestroyProbe(probe_ref);
 }
 
 
 PLUGIN_API void
 XPluginDisable(void)
 {
-    if (probe_ref)
-        XPLMDestroyProbe(probe_ref);
+    log_async(false);
 
     save_pref();
     log_msg("acc called:               %llu", stat_acc_called);
@@ -653,6 +816,14 @@ XPluginDisable(void)
     log_msg("last_dgs acc:             %llu", stat_dgs_acc_last);
     log_msg("stat_anim_acc_called:     %llu", stat_anim_acc_called);
     log_msg("stat_auto_drf_called:     %llu", stat_auto_drf_called);
+    log_msg("stat_jw_localized:        %llu", stat_jw_localized);
+    log_msg("stat_type_memo_hit:       %llu", stat_type_memo_hit);
+    log_msg("stat_type_memo_miss:      %llu", stat_type_memo_miss);
+    my_plane.log_sample_stats();
+    log_msg("log messages dropped:     %llu", log_dropped());
+    log_cat_stats();
+    prof_log();
+    trace_save();
 }
 
 
@@ -662,6 +833,7 @@ XPluginEnable(void)
     if (init_fail)  // once and for all
         return 0;
 
+    log_async(true);
     return 1;
 }
 
@@ -672,6 +844,7 @@ XPluginReceiveMessage([[maybe_unused]] XPLMPluginID in_from, long in_msg, void *
     //   Anyway it's too late for the current scenery.
     if ((in_msg == XPLM_MSG_AIRPORT_LOADED) ||
         (airport_loaded && (in_msg == XPLM_MSG_SCENERY_LOADED))) {
+        REC_EVENT(kRecEvAirportLoaded, in_msg);
         airport_loaded = 1;
         nh = (my_plane.lat() >= 0.0);
         set_season_auto();
@@ -680,11 +853,14 @@ XPluginReceiveMessage([[maybe_unused]] XPLMPluginID in_from, long in_msg, void *
 
     // my plane loaded
     if (in_msg == XPLM_MSG_PLANE_LOADED && in_param == 0) {
+        REC_PLANE();
+        REC_EVENT(kRecEvPlaneLoaded, 0);
         my_plane.plane_loaded();
         return;
     }
     // livery loaded
     if (in_msg == XPLM_MSG_LIVERY_LOADED && in_param == 0) {
+        REC_EVENT(kRecEvLiveryLoaded, 0);
         my_plane.livery_loaded();
         return;
     }
@@ -74,6 +74,12 @@ struct Scenery {
 
     float bb_lat_min, bb_lat_max, bb_lon_min, bb_lon_max;   /* bounding box for FAR_SKIP */
 
+    // cost attribution, dumped by openSAM/dump_scenery_cost
+    struct {
+        unsigned long long sc_far_skip, far_skip, near_skip, jw_match, anim_eval, stand_eval;
+        uint64_t ticks;     // with OS_PROFILE only
+    } cost{};
+
     Scenery() {
         sam_jws.reserve(100); stands.reserve(100);
         sam_objs.reserve(50);  sam_anims.reserve(50);
@@ -104,14 +110,41 @@ struct DoorInfo {
     float x, y, z;
 };
 
-// key is icao + <door num in ascii>
-extern std::unordered_map<std::string, DoorInfo> door_info_map;
-extern std::unordered_map<std::string, DoorInfo> csl_door_info_map;
+// all doors of a type in one record
+struct DoorInfoRec {
+    uint32_t icao;          // packed, 0 = empty slot
+    unsigned mask;          // bit d-1 set -> door d is defined
+    unsigned n_door;        // # of consecutively defined doors starting with door 1
+    DoorInfo door[kMaxDoor];
+
+    bool has_door(int d) const { return mask & (1 << (d - 1)); }    // d = 1..kMaxDoor
+};
+
+// Flat open addressing hash table keyed by the icao packed into 32 bits.
+// Lookup is a single allocation and exception free probe.
+class DoorInfoTable {
+    std::vector<DoorInfoRec> slots_;    // size is a power of 2
+    unsigned n_{0};
+
+    DoorInfoRec *probe(uint32_t key);
+    void grow();
+
+  public:
+    static uint32_t pack(const char *icao);     // 0 if empty or > 4 chars
+    static uint32_t pack(const std::string& icao) { return pack(icao.c_str()); }
+
+    void set(const char *icao, int d, const DoorInfo& di); // d = 1..kMaxDoor
+    const DoorInfoRec *find(const std::string& icao) const; // nullptr if not found
+    unsigned size() const { return n_; }
+};
+
+extern DoorInfoTable door_info_table, csl_door_info_table;
 // key is icao or iata -> icao
 extern std::unordered_map<std::string, std::string> acf_generic_type_map;
 
 extern std::string xp_dir;
 extern std::string base_dir;        // base directory of openSAM
+extern std::string pref_dir;        // X-Plane's preferences directory
 
 extern XPLMDataRef lat_ref_dr, lon_ref_dr,
     draw_object_x_dr, draw_object_y_dr, draw_object_z_dr, draw_object_psi_dr,
@@ -120,7 +153,9 @@ extern XPLMDataRef lat_ref_dr, lon_ref_dr,
 
 extern unsigned long long stat_sc_far_skip, stat_far_skip, stat_near_skip,
     stat_acc_called, stat_jw_match, stat_dgs_acc, stat_dgs_acc_last,
-    stat_anim_acc_called, stat_auto_drf_called;
+    stat_anim_acc_called, stat_auto_drf_called, stat_jw_localized,
+    stat_type_memo_hit, stat_type_memo_miss,
+    stat_my_update, stat_my_dr_read;
 
 extern float now;           // current timestamp
 
@@ -136,10 +171,48 @@ extern XPLMMenuID anim_menu;
 extern XPLMProbeInfo_t probeinfo;
 extern XPLMProbeRef probe_ref;
 
+// logging, messages above LOG_LEVEL are compiled out
+#define LOG_INFO  1
+#define LOG_DEBUG 2
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_INFO
+#endif
+
 // functions
 extern void log_msg(const char *fmt, ...) __attribute__ ((format (printf, 1, 2)));
 
+#if LOG_LEVEL >= LOG_DEBUG
+#define log_debug(...) log_msg(__VA_ARGS__)
+#else
+#define log_debug(...) do { if (0) log_msg(__VA_ARGS__); } while (0)
+#endif
+
+// rate limited categories, see log_config.txt
+enum LogCat { kLogDgs, kLogMp, kLogJw, kLogZc, kLogNumCat };
+extern void log_cat(LogCat cat, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+
+#if LOG_LEVEL >= LOG_DEBUG
+#define log_cat_debug(...) log_cat(__VA_ARGS__)
+#else
+#define log_cat_debug(...) do { if (0) log_cat(__VA_ARGS__); } while (0)
+#endif
+extern void log_load_config(const std::string& fn);
+extern void log_cat_stats(void);
+
+extern void log_async(bool on);     // queue messages for log_flush()
+extern void log_flush(void);        // from the flight loop only
+extern unsigned long long log_dropped(void);
+extern unsigned long long log_count(void);
+
 extern void toggle_ui(void);
+extern void toggle_perf_ui(void);
+
+// performance dashboard
+extern bool perf_ui_active;
+extern double perf_loop_us;                 // accumulated flight loop time
+extern void perf_baseline(void);            // for the deltas, e.g. after stats_reset()
+extern void mp_state_counts(unsigned *counts);  // per Plane::State
 
 #define BETWEEN(x ,a ,b) ((a) <= (x) && (x) <= (b))
 
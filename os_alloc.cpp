@@ -0,0 +1,128 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include "os_stats.h"
+
+const char * const alloc_family_str[kAllocNum] = {
+    "other", "flight_loop", "mp", "jw", "dgs", "jw_acc", "dgs_acc", "anim_acc"
+};
+
+unsigned long long alloc_n[kAllocNum], alloc_bytes[kAllocNum], alloc_free_n;
+unsigned long long stat_alloc_loop_n, stat_alloc_loop_bytes, stat_alloc_loop_max_n;
+
+#ifdef OS_ALLOC_TRACK
+
+// all plugin code runs in XP's main thread so plain counters do
+AllocFamily alloc_cur = kAllocOther;
+
+static unsigned long long
+total(const unsigned long long *v)
+{
+    unsigned long long t = 0;
+    for (int i = 0; i < kAllocNum; i++)
+        t += v[i];
+    return t;
+}
+
+AllocLoopScope::AllocLoopScope() : n0_(total(alloc_n)), bytes0_(total(alloc_bytes))
+{
+}
+
+AllocLoopScope::~AllocLoopScope()
+{
+    stat_alloc_loop_n = total(alloc_n) - n0_;
+    stat_alloc_loop_bytes = total(alloc_bytes) - bytes0_;
+    if (stat_alloc_loop_n > stat_alloc_loop_max_n)
+        stat_alloc_loop_max_n = stat_alloc_loop_n;
+}
+
+// The replacements below must bind to the plugin's own code only.
+// Windows dlls and macOS two-level namespaces do that by default, on Linux
+// the plugin is linked with -Bsymbolic (see Makefile.lin64). X-Plane loads
+// plugins with RTLD_LOCAL so nothing else picks up these operators.
+
+static inline void *
+tracked_alloc(size_t size)
+{
+    alloc_n[alloc_cur]++;
+    alloc_bytes[alloc_cur] += size;
+    return malloc(size ? size : 1);
+}
+
+void *
+operator new(size_t size)
+{
+    void *p = tracked_alloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void *
+operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *
+operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return tracked_alloc(size);
+}
+
+void *
+operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return tracked_alloc(size);
+}
+
+void
+operator delete(void *p) noexcept
+{
+    if (p) {
+        alloc_free_n++;
+        free(p);
+    }
+}
+
+void
+operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete(void *p, [[maybe_unused]] size_t size) noexcept
+{
+    operator delete(p);
+}
+
+void
+operator delete[](void *p, [[maybe_unused]] size_t size) noexcept
+{
+    operator delete(p);
+}
+#endif
@@ -26,6 +26,9 @@
 
 #include "openSAM.h"
 #include "os_anim.h"
+#include "os_stats.h"
+#include "os_trace.h"
+#include "os_rec.h"
 
 static const float SAM_2_OBJ_MAX = 2.5;     // m, max delta between coords in sam.xml and object
 static const float SAM_2_OBJ_HDG_MAX = 5;   // °, likewise for heading
@@ -44,6 +47,8 @@ static Scenery* menu_sc;          // the scenery the menu is built of
 static float
 anim_acc(void *ref)
 {
+    PROF_SCOPE(kProfAnim);
+    ALLOC_SCOPE(kAllocAnimAcc);
     stat_anim_acc_called++;
 
     float obj_x = XPLMGetDataf(draw_object_x_dr);
@@ -64,6 +69,7 @@ anim_acc(void *ref)
     int drf_idx = (uint64_t)ref;
 
     for (auto sc : sceneries) {
+        PROF_SC_COST(sc);
         for (auto anim : sc->sam_anims) {
             if (drf_idx != anim->drf_idx)
                 continue;
@@ -76,6 +82,7 @@ anim_acc(void *ref)
             if (obj->xml_ref_gen < ref_gen) {
                 double  x, y ,z;
                 XPLMWorldToLocal(obj->latitude, obj->longitude, obj->elevation, &x, &y, &z);
+                REC_W2L(obj->latitude, obj->longitude, obj->elevation, x, y, z);
 
                 obj->xml_x = x;
                 obj->xml_y = y;
@@ -85,9 +92,12 @@ anim_acc(void *ref)
 
             if (fabs(obj_x - obj->xml_x) > SAM_2_OBJ_MAX || fabs(obj_z - obj->xml_z) > SAM_2_OBJ_MAX) {
                 stat_near_skip++;
+                sc->cost.near_skip++;
                 continue;
             }
 
+            sc->cost.anim_eval++;
+
             SamDrf *drf = sam_drfs[drf_idx];
             //log_msg("acc %s called, %s %s", drf->name, anim->label, anim->title);
 
@@ -134,6 +144,8 @@ anim_acc(void *ref)
 static float
 auto_drf_acc(void *ref)
 {
+    PROF_SCOPE(kProfAutoDrf);
+    ALLOC_SCOPE(kAllocAnimAcc);
     stat_auto_drf_called++;
 
     const SamDrf *drf = (const SamDrf *)ref;
@@ -159,6 +171,7 @@ auto_drf_acc(void *ref)
 void
 anim_menu_cb([[maybe_unused]] void *menu_ref, void *item_ref)
 {
+    REC_EVENT(kRecEvAnimMenu, (int)(uint64_t)item_ref);
     if (NULL == menu_sc)    // just in case
         return;
 
@@ -213,6 +226,7 @@ build_menu(Scenery* sc)
 float
 anim_state_machine(void)
 {
+    TRACE_SCOPE("anim_state_machine");
     // check whether we have recently seen a scenery
     if (cur_sc && now > cur_sc_ts + 180.0f) {
         log_msg("have not seen a custom animated scenery recently");
@@ -243,7 +257,7 @@ anim_init()
                                      NULL, NULL, NULL, (void *)drf, NULL);
         else
             XPLMRegisterDataAccessor(drf->name, xplmType_Float, 0, NULL,
-                                     NULL, anim_acc, NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, REC_ACC(anim_acc, kRecAnim), NULL, NULL, NULL, NULL, NULL, NULL,
                                      NULL, NULL, NULL, (void *)(uint64_t)i, NULL);
     }
 
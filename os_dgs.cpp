@@ -27,6 +27,9 @@
 #include "openSAM.h"
 #include "os_dgs.h"
 #include "plane.h"
+#include "os_stats.h"
+#include "os_trace.h"
+#include "os_rec.h"
 
 #include "XPLMInstance.h"
 #include "XPLMNavigation.h"
@@ -81,7 +84,7 @@ static float marshaller_x, marshaller_y, marshaller_z, marshaller_y_0, marshalle
 static XPLMObjectRef marshaller_obj, stairs_obj;
 static XPLMInstanceRef marshaller_inst, stairs_inst;
 
-static int update_stand_log_ts;   // throttling of logging
+static float update_stand_log_ts;   // throttling of logging
 static float sin_wave_prev;
 
 enum _DGS_DREF {
@@ -153,6 +156,12 @@ dgs_set_inactive(void)
     }
 }
 
+bool
+dgs_tracking(void)
+{
+    return ENGAGED <= state && state <= PARKED;
+}
+
 // set mode to arrival
 void
 dgs_set_active(void)
@@ -192,6 +201,7 @@ Stand::xform_to_ref_frame()
     if (ref_gen_ < ::ref_gen) {
         XPLMWorldToLocal(lat, lon, my_plane.elevation(),
                          &stand_x, &stand_y, &stand_z);
+        REC_W2L(lat, lon, my_plane.elevation(), stand_x, stand_y, stand_z);
         ref_gen_ = ::ref_gen;
         dgs_assoc = 0;    // association is lost
         max_dgs_z_l = last_dgs_x = -1.0E10;
@@ -266,6 +276,8 @@ is_dgs_active(float obj_x, float obj_z, float obj_psi)
 static float
 read_dgs_acc(void *ref)
 {
+    PROF_SCOPE(kProfDgs);
+    ALLOC_SCOPE(kAllocDgsAcc);
 
     float obj_x = XPLMGetDataf(draw_object_x_dr);
     float obj_z = XPLMGetDataf(draw_object_z_dr);
@@ -303,6 +315,8 @@ read_dgs_acc(void *ref)
 static float
 read_sam1_acc(void *ref)
 {
+    PROF_SCOPE(kProfSam1);
+    ALLOC_SCOPE(kAllocDgsAcc);
     int dr_index = (uint64_t)ref;
     if (!is_dgs_active(XPLMGetDataf(draw_object_x_dr), XPLMGetDataf(draw_object_z_dr),
                        XPLMGetDataf(draw_object_psi_dr)))
@@ -376,6 +390,8 @@ find_nearest_stand()
             continue;
         }
 
+        PROF_SC_COST(sc);
+        sc->cost.stand_eval += sc->stands.size();
         for (auto stand : sc->stands) {
 
             // heading in local system
@@ -471,7 +487,7 @@ dgs_init()
     // create the dgs animation datarefs
     for (int i = 0; i < DGS_DR_NUM; i++)
         XPLMRegisterDataAccessor(dgs_dlist_dr[i], xplmType_Float, 0, NULL,
-                                 NULL, read_dgs_acc, NULL, NULL, NULL, NULL, NULL, NULL,
+                                 NULL, REC_ACC(read_dgs_acc, kRecDgs), NULL, NULL, NULL, NULL, NULL, NULL,
                                  NULL, NULL, NULL, (void *)(uint64_t)i, NULL);
 
     XPLMRegisterDataAccessor("sam/vdgs/status", xplmType_Float, 0, NULL,
@@ -514,6 +530,8 @@ dgs_init()
 float
 dgs_state_machine()
 {
+    TRACE_SCOPE("dgs_state_machine");
+    ALLOC_SCOPE(kAllocDgs);
     if (state <= INACTIVE)
         return 2.0;
 
@@ -624,11 +642,11 @@ dgs_state_machine()
                 float d_hdgt = req_hdgt - local_hdgt;   // degrees to turn
 
                 if (now > update_stand_log_ts + 2.0f)
-                    log_msg("is_marshaller: %d, azimuth: %0.1f, mw: (%0.1f, %0.1f), nw: (%0.1f, %0.1f), ref: (%0.1f, %0.1f), "
-                           "x: %0.1f, local_hdgt: %0.1f, d_hdgt: %0.1f",
-                           is_marshaller, azimuth, mw_x, mw_z, nw_x, nw_z,
-                           x_dr, z_dr,
-                           local_x, local_hdgt, d_hdgt);
+                    log_cat_debug(kLogDgs, "is_marshaller: %d, azimuth: %0.1f, mw: (%0.1f, %0.1f), nw: (%0.1f, %0.1f), ref: (%0.1f, %0.1f), "
+                                  "x: %0.1f, local_hdgt: %0.1f, d_hdgt: %0.1f",
+                                  is_marshaller, azimuth, mw_x, mw_z, nw_x, nw_z,
+                                  x_dr, z_dr,
+                                  local_x, local_hdgt, d_hdgt);
 
                 if (d_hdgt < -1.5)
                     lr = 2;
@@ -800,8 +818,10 @@ dgs_state_machine()
 
                 // now check whether it's Marshaller_high
 
-                if (xplm_ProbeHitTerrain == XPLMProbeTerrainXYZ(probe_ref, marshaller_x, marshaller_y, marshaller_z,
-                                                               &probeinfo)) {
+                XPLMProbeResult res = XPLMProbeTerrainXYZ(probe_ref, marshaller_x, marshaller_y, marshaller_z,
+                                                          &probeinfo);
+                REC_PROBE(marshaller_x, marshaller_y, marshaller_z, res, probeinfo);
+                if (xplm_ProbeHitTerrain == res) {
                     marshaller_y_0 = probeinfo.locationY;   // ground 0
 
                     if (marshaller_y - marshaller_y_0 > 2.0f) {
@@ -834,11 +854,11 @@ dgs_state_machine()
         // don't flood the log
         if (now > update_stand_log_ts + 2.0f) {
             update_stand_log_ts = now;
-            log_msg("stand: %s, state: %s, assoc: %d, status: %d, track: %d, lr: %d, distance: %0.2f, azimuth: %0.1f",
-                   nearest_stand->id, state_str[state], dgs_assoc,
-                   status, track, lr, distance, azimuth);
-            log_msg("sam1: status %0.0f, lateral: %0.1f, longitudinal: %0.1f",
-                    sam1_status, sam1_lateral, sam1_longitudinal);
+            log_cat_debug(kLogDgs, "stand: %s, state: %s, assoc: %d, status: %d, track: %d, lr: %d, distance: %0.2f, azimuth: %0.1f, "
+                          "sam1: status %0.0f, lateral: %0.1f, longitudinal: %0.1f",
+                          nearest_stand->id, state_str[state], dgs_assoc,
+                          status, track, lr, distance, azimuth,
+                          sam1_status, sam1_lateral, sam1_longitudinal);
         }
     }
 
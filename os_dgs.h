@@ -40,5 +40,6 @@ extern int dgs_init(void);
 extern float dgs_state_machine(void);
 extern void dgs_set_active(void);
 extern void dgs_set_inactive(void);
+extern bool dgs_tracking(void);     // DGS is guiding the plane in
 
 
@@ -0,0 +1,267 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "openSAM.h"
+#include "os_rec.h"
+
+#ifdef OS_ACC_RECORD
+
+#include "plane.h"
+#include "samjw.h"
+#include "os_anim.h"
+
+#include "XPLMPlanes.h"
+
+static const char *rec_fn = "Output/openSAM_acc.rec";
+
+static FILE *rec_f;
+static unsigned long long rec_n_acc, rec_n_loop;
+
+static RecFrame last_frame;
+static RecObj last_obj;
+static bool last_obj_valid;
+
+static XPLMDataRef plane_x_dr, plane_y_dr, plane_z_dr, plane_psi_dr, plane_y_agl_dr,
+    plane_lat_dr, plane_lon_dr, plane_elevation_dr, gear_fnrml_dr, parkbrake_dr, beacon_dr,
+    eng_running_dr, percent_lights_dr, sin_wave_dr,
+    acf_icao_dr, acf_cg_y_dr, acf_cg_z_dr, acf_gear_z_dr, acf_door_x_dr, acf_door_y_dr, acf_door_z_dr,
+    is_helicopter_dr;
+
+static void
+put(RecTag tag, const void *rec, size_t size)
+{
+    if (rec_f == nullptr)
+        return;
+
+    fputc(tag, rec_f);
+    fwrite(rec, size, 1, rec_f);
+}
+
+static void
+get_frame(RecFrame& f)
+{
+    f.t = XPLMGetDataf(total_running_time_sec_dr);
+    f.lat_ref = XPLMGetDataf(lat_ref_dr);
+    f.lon_ref = XPLMGetDataf(lon_ref_dr);
+    f.lat = XPLMGetDataf(plane_lat_dr);
+    f.lon = XPLMGetDataf(plane_lon_dr);
+}
+
+void
+rec_open()
+{
+    std::string fn = xp_dir + rec_fn;
+    rec_f = fopen(fn.c_str(), "wb");
+    if (rec_f == nullptr) {
+        log_msg("can't create '%s'", fn.c_str());
+        return;
+    }
+
+    setvbuf(rec_f, nullptr, _IOFBF, 1024 * 1024);
+
+    plane_x_dr = XPLMFindDataRef("sim/flightmodel/position/local_x");
+    plane_y_dr = XPLMFindDataRef("sim/flightmodel/position/local_y");
+    plane_z_dr = XPLMFindDataRef("sim/flightmodel/position/local_z");
+    plane_psi_dr = XPLMFindDataRef("sim/flightmodel2/position/true_psi");
+    plane_y_agl_dr = XPLMFindDataRef("sim/flightmodel2/position/y_agl");
+    plane_lat_dr = XPLMFindDataRef("sim/flightmodel/position/latitude");
+    plane_lon_dr = XPLMFindDataRef("sim/flightmodel/position/longitude");
+    plane_elevation_dr = XPLMFindDataRef("sim/flightmodel/position/elevation");
+    gear_fnrml_dr = XPLMFindDataRef("sim/flightmodel/forces/fnrml_gear");
+    parkbrake_dr = XPLMFindDataRef("sim/flightmodel/controls/parkbrake");
+    beacon_dr = XPLMFindDataRef("sim/cockpit2/switches/beacon_on");
+    eng_running_dr = XPLMFindDataRef("sim/flightmodel/engine/ENGN_running");
+    percent_lights_dr = XPLMFindDataRef("sim/graphics/scenery/percent_lights_on");
+    sin_wave_dr = XPLMFindDataRef("sim/graphics/animation/sin_wave_2");
+    acf_icao_dr = XPLMFindDataRef("sim/aircraft/view/acf_ICAO");
+    acf_cg_y_dr = XPLMFindDataRef("sim/aircraft/weight/acf_cgY_original");
+    acf_cg_z_dr = XPLMFindDataRef("sim/aircraft/weight/acf_cgZ_original");
+    acf_gear_z_dr = XPLMFindDataRef("sim/aircraft/parts/acf_gear_znodef");
+    acf_door_x_dr = XPLMFindDataRef("sim/aircraft/view/acf_door_x");
+    acf_door_y_dr = XPLMFindDataRef("sim/aircraft/view/acf_door_y");
+    acf_door_z_dr = XPLMFindDataRef("sim/aircraft/view/acf_door_z");
+    is_helicopter_dr = XPLMFindDataRef("sim/aircraft2/metadata/is_helicopter");
+
+    RecHeader h{};
+    memcpy(h.magic, kRecMagic, sizeof(h.magic));
+    strncpy(h.version, VERSION, sizeof(h.version) - 1);
+    h.n_sceneries = sceneries.size();
+    for (auto sc : sceneries) {
+        h.n_jetways += sc->sam_jws.size();
+        h.n_stands += sc->stands.size();
+    }
+    h.n_drfs = sam_drfs.size();
+    fwrite(&h, sizeof(h), 1, rec_f);
+
+    last_frame = RecFrame{};
+    last_obj_valid = false;
+    log_msg("recording accessor calls to '%s'", fn.c_str());
+}
+
+void
+rec_close()
+{
+    if (rec_f == nullptr)
+        return;
+
+    fclose(rec_f);
+    rec_f = nullptr;
+    log_msg("recorded %llu accessor calls, %llu flight loop calls", rec_n_acc, rec_n_loop);
+}
+
+RecAccCall::RecAccCall(RecAccKind kind, void *ref) : kind_(kind), ref_((uint64_t)ref)
+{
+    RecFrame f;
+    get_frame(f);
+    if (memcmp(&f, &last_frame, sizeof(f))) {
+        put(kRecFrame, &f, sizeof(f));
+        last_frame = f;
+    }
+
+    obj_.x = XPLMGetDataf(draw_object_x_dr);
+    obj_.y = XPLMGetDataf(draw_object_y_dr);
+    obj_.z = XPLMGetDataf(draw_object_z_dr);
+    obj_.psi = XPLMGetDataf(draw_object_psi_dr);
+}
+
+float
+RecAccCall::done(float val)
+{
+    if (rec_f == nullptr)
+        return val;
+
+    rec_n_acc++;
+
+    // mostly several datarefs of the same object are queried in a row
+    bool same = last_obj_valid && memcmp(&obj_, &last_obj, sizeof(obj_)) == 0;
+
+    uint8_t buf[1 + 10 + sizeof(RecObj) + sizeof(float)];
+    int n = 0;
+    buf[n++] = kRecAcc | kind_ << 1 | same;
+
+    uint64_t r = ref_;
+    do {
+        buf[n] = r & 0x7f;
+        r >>= 7;
+        if (r)
+            buf[n] |= 0x80;
+        n++;
+    } while (r);
+
+    if (!same) {
+        memcpy(buf + n, &obj_, sizeof(obj_));
+        n += sizeof(obj_);
+        last_obj = obj_;
+        last_obj_valid = true;
+    }
+
+    memcpy(buf + n, &val, sizeof(val));
+    n += sizeof(val);
+    fwrite(buf, n, 1, rec_f);
+    return val;
+}
+
+RecLoopScope::RecLoopScope(bool mp_active)
+{
+    get_frame(rec_.f);
+    rec_.x = XPLMGetDataf(plane_x_dr);
+    rec_.y = XPLMGetDataf(plane_y_dr);
+    rec_.z = XPLMGetDataf(plane_z_dr);
+    rec_.psi = XPLMGetDataf(plane_psi_dr);
+    rec_.y_agl = XPLMGetDataf(plane_y_agl_dr);
+    rec_.elevation = XPLMGetDataf(plane_elevation_dr);
+    rec_.gear_fnrml = XPLMGetDataf(gear_fnrml_dr);
+    rec_.parkbrake = XPLMGetDataf(parkbrake_dr);
+    rec_.beacon = XPLMGetDatai(beacon_dr);
+
+    int eng_running[8];
+    rec_.n_eng = XPLMGetDatavi(eng_running_dr, eng_running, 0, 8);
+    rec_.eng_running = 0;
+    for (int i = 0; i < rec_.n_eng; i++)
+        if (eng_running[i])
+            rec_.eng_running |= 1 << i;
+
+    rec_.requests = my_plane.requests();
+    rec_.auto_mode = my_plane.auto_mode();
+    rec_.mp_active = mp_active;
+    rec_.percent_lights = XPLMGetDataf(percent_lights_dr);
+    rec_.sin_wave = XPLMGetDataf(sin_wave_dr);
+}
+
+RecLoopScope::~RecLoopScope()
+{
+    rec_n_loop++;
+    put(kRecLoop, &rec_, sizeof(rec_));
+}
+
+RecEventScope::RecEventScope(RecEventKind kind, int arg)
+    : rec_{kind, arg, XPLMGetDataf(total_running_time_sec_dr)}
+{
+}
+
+RecEventScope::~RecEventScope()
+{
+    put(kRecEvent, &rec_, sizeof(rec_));
+}
+
+void
+rec_plane()
+{
+    RecPlane p{};
+    XPLMGetDatab(acf_icao_dr, p.icao, 0, sizeof(p.icao));
+    p.cg_y = XPLMGetDataf(acf_cg_y_dr);
+    p.cg_z = XPLMGetDataf(acf_cg_z_dr);
+    float gear_z[2];
+    p.n_gear_z = XPLMGetDatavf(acf_gear_z_dr, gear_z, 0, 2);
+    memcpy(p.gear_z, gear_z, sizeof(gear_z));
+    p.is_helicopter = XPLMGetDatai(is_helicopter_dr);
+    p.door_x = XPLMGetDataf(acf_door_x_dr);
+    p.door_y = XPLMGetDataf(acf_door_y_dr);
+    p.door_z = XPLMGetDataf(acf_door_z_dr);
+
+    char acf_file[256];
+    XPLMGetNthAircraftModel(XPLM_USER_AIRCRAFT, acf_file, p.acf_path);
+    put(kRecPlane, &p, sizeof(p));
+}
+
+void
+rec_xform(RecTag tag, double i0, double i1, double i2, double o0, double o1, double o2)
+{
+    RecXform x{{i0, i1, i2}, {o0, o1, o2}};
+    put(tag, &x, sizeof(x));
+}
+
+void
+rec_probe(float x, float y, float z, XPLMProbeResult res, const XPLMProbeInfo_t& info)
+{
+    RecProbe p{x, y, z, res, info.locationX, info.locationY, info.locationZ};
+    put(kRecProbe, &p, sizeof(p));
+}
+
+#else
+void rec_open() {}
+void rec_close() {}
+#endif
@@ -0,0 +1,178 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _OS_REC_H_
+#define _OS_REC_H_
+
+//
+// Accessor call recording, compile with -DOS_ACC_RECORD.
+//
+// The whole session is written to Output/openSAM_acc.rec:
+//  - every call of jw_anim_acc(), read_dgs_acc() and anim_acc() with the draw object
+//    position and the result
+//  - the reference frame, time and plane position at draw time
+//  - the state of my plane as seen by each flight loop call
+//  - commands and messages that change the state of openSAM
+//  - coordinate transformations and terrain probes with their results
+//
+// bench/os_replay feeds it back through the accessors on the XPLM stand-in.
+// A record is written when its call returns so the transformations done
+// within the call precede it in the file.
+//
+// Without OS_ACC_RECORD the REC_*() macros expand to nothing.
+//
+
+#include <cstdint>
+
+#include "XPLMScenery.h"
+
+static const char kRecMagic[8] = {'O', 'S', 'A', 'M', 'R', 'E', 'C', '1'};
+
+enum RecTag : uint8_t {
+    kRecFrame = 'F',    // RecFrame, written when it changes
+    kRecLoop = 'L',     // RecLoop, flight loop call
+    kRecEvent = 'E',    // RecEvent
+    kRecPlane = 'Q',    // RecPlane, precedes kRecEvPlaneLoaded
+    kRecW2L = 'W',      // RecXform, XPLMWorldToLocal
+    kRecL2W = 'T',      // RecXform, XPLMLocalToWorld
+    kRecProbe = 'P',    // RecProbe
+
+    // accessor call: kRecAcc | kind << 1 | same object as last call,
+    // followed by the refcon as LEB128, RecObj if not the same object, the float result
+    kRecAcc = 0x80
+};
+
+enum RecAccKind : uint8_t { kRecJw, kRecDgs, kRecAnim, kRecAccNum };
+
+enum RecEventKind : uint8_t { kRecEvActivate, kRecEvAnimMenu, kRecEvToggleMp,
+                              kRecEvPlaneLoaded, kRecEvLiveryLoaded, kRecEvAirportLoaded };
+
+// bits of RecLoop::requests
+enum { kRecReqDock = 1, kRecReqUndock = 2, kRecReqToggle = 4 };
+
+#pragma pack(push, 1)
+struct RecHeader {
+    char magic[8];
+    char version[32];
+    uint32_t n_sceneries, n_jetways, n_stands, n_drfs;  // sanity check on replay
+};
+
+struct RecFrame {
+    float t, lat_ref, lon_ref;
+    float lat, lon;             // of my plane
+};
+
+struct RecLoop {
+    RecFrame f;
+    float x, y, z, psi, y_agl, elevation, gear_fnrml, parkbrake;
+    int32_t beacon;
+    uint8_t n_eng, eng_running;     // bit mask
+    uint8_t requests, auto_mode, mp_active;
+    float percent_lights, sin_wave;
+};
+
+struct RecEvent {
+    uint8_t kind;
+    int32_t arg;
+    float t;
+};
+
+struct RecPlane {
+    char icao[4];
+    float cg_y, cg_z;
+    uint8_t n_gear_z;
+    float gear_z[2];
+    int32_t is_helicopter;
+    float door_x, door_y, door_z;
+    char acf_path[512];
+};
+
+struct RecXform {
+    double in[3], out[3];
+};
+
+struct RecProbe {
+    float x, y, z;
+    int32_t result;
+    float loc_x, loc_y, loc_z;
+};
+
+struct RecObj {
+    float x, y, z, psi;
+};
+#pragma pack(pop)
+
+// start recording at the end of XPluginStart, stop in XPluginDisable
+extern void rec_open(void);
+extern void rec_close(void);
+
+#ifdef OS_ACC_RECORD
+struct RecAccCall {
+    RecAccKind kind_;
+    uint64_t ref_;
+    RecObj obj_;
+    RecAccCall(RecAccKind kind, void *ref);
+    float done(float val);
+};
+
+// registered instead of the accessor f
+template<RecAccKind kind, float (*f)(void *)>
+float
+rec_acc(void *ref)
+{
+    RecAccCall call(kind, ref);
+    return call.done(f(ref));
+}
+
+struct RecLoopScope {
+    RecLoop rec_;
+    RecLoopScope(bool mp_active);
+    ~RecLoopScope();
+};
+
+struct RecEventScope {
+    RecEvent rec_;
+    RecEventScope(RecEventKind kind, int arg);
+    ~RecEventScope();
+};
+
+extern void rec_plane(void);
+extern void rec_xform(RecTag tag, double i0, double i1, double i2, double o0, double o1, double o2);
+extern void rec_probe(float x, float y, float z, XPLMProbeResult res, const XPLMProbeInfo_t& info);
+
+#define REC_ACC(f, kind) rec_acc<kind, f>
+#define REC_LOOP(mp_active) RecLoopScope rec_loop_scope_(mp_active)
+#define REC_EVENT(kind, arg) RecEventScope rec_event_scope_(kind, arg)
+#define REC_PLANE() rec_plane()
+#define REC_W2L(lat, lon, alt, x, y, z) rec_xform(kRecW2L, lat, lon, alt, x, y, z)
+#define REC_L2W(x, y, z, lat, lon, alt) rec_xform(kRecL2W, x, y, z, lat, lon, alt)
+#define REC_PROBE(x, y, z, res, info) rec_probe(x, y, z, res, info)
+#else
+#define REC_ACC(f, kind) f
+#define REC_LOOP(mp_active)
+#define REC_EVENT(kind, arg)
+#define REC_PLANE()
+#define REC_W2L(lat, lon, alt, x, y, z)
+#define REC_L2W(x, y, z, lat, lon, alt)
+#define REC_PROBE(x, y, z, res, info)
+#endif
+
+#endif
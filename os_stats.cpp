@@ -0,0 +1,431 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "openSAM.h"
+#include "os_stats.h"
+#include "os_trace.h"
+
+#include "XPLMUtilities.h"
+#include "XPLMProcessing.h"
+
+static constexpr float kRateInterval = 1.0f;    // (s) rate computation
+
+// a counter has a rate and is reset, a snapshot is the current value of
+// something, a high water mark is only reset
+enum StatKind { kStatCounter, kStatSnapshot, kStatMax };
+
+struct Stat {
+    const char *name;
+    unsigned long long *counter;
+    StatKind kind{kStatCounter};
+    unsigned long long prev{0};     // value at last rate computation
+    double rate{0.0};               // per second
+};
+
+static std::vector<Stat> stats = {
+    {"acc_called", &stat_acc_called},
+    {"sc_far_skip", &stat_sc_far_skip},
+    {"far_skip", &stat_far_skip},
+    {"near_skip", &stat_near_skip},
+    {"jw_match", &stat_jw_match},
+    {"dgs_acc", &stat_dgs_acc},
+    {"dgs_acc_last", &stat_dgs_acc_last, kStatSnapshot},
+    {"anim_acc_called", &stat_anim_acc_called},
+    {"auto_drf_called", &stat_auto_drf_called},
+    {"jw_localized", &stat_jw_localized},
+    {"type_memo_hit", &stat_type_memo_hit},
+    {"type_memo_miss", &stat_type_memo_miss},
+    {"my_update", &stat_my_update},
+    {"my_dr_read", &stat_my_dr_read},
+};
+
+#ifdef OS_ALLOC_TRACK
+static std::string alloc_stat_names[2 * kAllocNum];
+#endif
+
+static float rate_ts;   // ts of last rate computation
+
+static void prof_init(void);
+static void prof_reset(void);
+static double prof_ticks_2_ms(uint64_t ticks);
+
+static double
+stat_value_acc(void *ref)
+{
+    return (double)*((Stat *)ref)->counter;
+}
+
+static double
+stat_rate_acc(void *ref)
+{
+    return ((Stat *)ref)->rate;
+}
+
+static int
+cmd_reset_stats_cb([[maybe_unused]] XPLMCommandRef cmdr, XPLMCommandPhase phase,
+                   [[maybe_unused]] void *ref)
+{
+    if (xplm_CommandBegin != phase)
+        return 0;
+
+    log_msg("cmd reset_stats");
+    stats_reset();
+    return 0;
+}
+
+//==============  Per scenery cost ====
+static const char *scenery_cost_fn = "Output/openSAM_scenery_cost.csv";
+
+static unsigned long long
+work(const Scenery *sc)
+{
+    auto& c = sc->cost;
+    return c.far_skip + c.near_skip + c.jw_match + c.anim_eval + c.stand_eval;
+}
+
+// quoted, embedded '"' doubled
+static void
+csv_string(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"')
+            fputc('"', f);
+        fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+// sort by time if profiled, otherwise by work done
+void
+dump_scenery_cost(void)
+{
+    std::vector<Scenery *> scs(sceneries);
+    std::sort(scs.begin(), scs.end(),
+              [] (const Scenery *a, const Scenery *b) {
+                  if (a->cost.ticks != b->cost.ticks)
+                      return a->cost.ticks > b->cost.ticks;
+                  return work(a) > work(b);
+              });
+
+    log_msg("scenery cost, top offenders:");
+    for (int i = 0; i < std::min((int)scs.size(), 20); i++) {
+        auto sc = scs[i];
+        auto& c = sc->cost;
+        if (c.ticks == 0 && work(sc) == 0)
+            break;
+
+        log_msg("%-40s match: %llu, near_skip: %llu, far_skip: %llu, sc_far_skip: %llu, anim: %llu, stand: %llu, ms: %0.3f",
+                sc->name, c.jw_match, c.near_skip, c.far_skip, c.sc_far_skip, c.anim_eval,
+                c.stand_eval, prof_ticks_2_ms(c.ticks));
+    }
+
+    std::string fn = xp_dir + scenery_cost_fn;
+    FILE *f = fopen(fn.c_str(), "w");
+    if (f == NULL) {
+        log_msg("can't create '%s'", fn.c_str());
+        return;
+    }
+
+    fputs("scenery,jw_match,near_skip,far_skip,sc_far_skip,anim_eval,stand_eval,ms\n", f);
+    for (auto sc : scs) {
+        auto& c = sc->cost;
+        csv_string(f, sc->name);
+        fprintf(f, ",%llu,%llu,%llu,%llu,%llu,%llu,%0.3f\n",
+                c.jw_match, c.near_skip, c.far_skip, c.sc_far_skip, c.anim_eval,
+                c.stand_eval, prof_ticks_2_ms(c.ticks));
+    }
+
+    fclose(f);
+    log_msg("scenery cost written to '%s'", fn.c_str());
+}
+
+static int
+cmd_dump_scenery_cost_cb([[maybe_unused]] XPLMCommandRef cmdr, XPLMCommandPhase phase,
+                         [[maybe_unused]] void *ref)
+{
+    if (xplm_CommandBegin == phase)
+        dump_scenery_cost();
+    return 0;
+}
+
+void
+stats_init(void)
+{
+#ifdef OS_ALLOC_TRACK
+    // allocations by family, no reallocation of stats after this point
+    stats.push_back({"alloc_free_n", &alloc_free_n});
+    stats.push_back({"alloc_loop_n", &stat_alloc_loop_n, kStatSnapshot});
+    stats.push_back({"alloc_loop_bytes", &stat_alloc_loop_bytes, kStatSnapshot});
+    stats.push_back({"alloc_loop_max_n", &stat_alloc_loop_max_n, kStatMax});
+    for (int i = 0; i < kAllocNum; i++) {
+        alloc_stat_names[2 * i] = std::string("alloc_") + alloc_family_str[i] + "_n";
+        alloc_stat_names[2 * i + 1] = std::string("alloc_") + alloc_family_str[i] + "_bytes";
+        stats.push_back({alloc_stat_names[2 * i].c_str(), &alloc_n[i]});
+        stats.push_back({alloc_stat_names[2 * i + 1].c_str(), &alloc_bytes[i]});
+    }
+#endif
+
+    char name[100];
+    for (auto& s : stats) {
+        snprintf(name, sizeof(name), "opensam/stats/%s", s.name);
+        XPLMRegisterDataAccessor(name, xplmType_Double, 0, NULL, NULL,
+                                 NULL, NULL, stat_value_acc, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, &s, NULL);
+
+        if (s.kind != kStatCounter)
+            continue;
+
+        snprintf(name, sizeof(name), "opensam/stats/%s_rate", s.name);
+        XPLMRegisterDataAccessor(name, xplmType_Double, 0, NULL, NULL,
+                                 NULL, NULL, stat_rate_acc, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, &s, NULL);
+    }
+
+    XPLMCommandRef reset_cmdr = XPLMCreateCommand("openSAM/reset_stats", "Reset performance counters");
+    XPLMRegisterCommandHandler(reset_cmdr, cmd_reset_stats_cb, 0, NULL);
+
+    XPLMCommandRef cost_cmdr = XPLMCreateCommand("openSAM/dump_scenery_cost", "Dump cost per scenery");
+    XPLMRegisterCommandHandler(cost_cmdr, cmd_dump_scenery_cost_cb, 0, NULL);
+
+    prof_init();
+}
+
+void
+stats_update(void)
+{
+    float dt = now - rate_ts;
+    if (dt < kRateInterval)
+        return;
+
+    for (auto& s : stats) {
+        if (s.kind != kStatCounter)
+            continue;
+
+        unsigned long long v = *s.counter;
+        s.rate = (v - s.prev) / dt;
+        s.prev = v;
+    }
+
+    rate_ts = now;
+}
+
+void
+stats_reset(void)
+{
+    for (auto& s : stats) {
+        if (s.kind == kStatSnapshot)
+            continue;
+
+        *s.counter = s.prev = 0;
+        s.rate = 0.0;
+    }
+
+    rate_ts = now;
+    prof_reset();
+    trace_baseline();
+    perf_baseline();
+
+    for (auto sc : sceneries)
+        sc->cost = {};
+}
+
+//==============  Accessor profiling ====
+#ifdef OS_PROFILE
+static constexpr int kProfBuckets = 64;     // log2 of ticks
+
+struct ProfHist {
+    const char *name;
+    unsigned long long n{0};
+    uint64_t frame_ticks{0};        // accumulated in the current frame
+    float last_frame_us{0.0f};      // total of the last frame
+    unsigned long long bucket[kProfBuckets]{};
+};
+
+// the last one is the per frame total of all accessors
+static ProfHist prof_hist[kProfNum + 1] = {
+    {"jw_anim_acc"}, {"read_dgs_acc"}, {"read_sam1_acc"}, {"anim_acc"}, {"auto_drf_acc"},
+    {"frame"}
+};
+
+// tick -> ns calibration against steady_clock
+static uint64_t cal_ticks0;
+static std::chrono::steady_clock::time_point cal_ts0;
+static double ns_per_tick = 1.0;
+
+static inline int
+log2_bucket(uint64_t ticks)
+{
+    return ticks ? 63 - __builtin_clzll(ticks) : 0;
+}
+
+void
+prof_record(ProfAcc acc, uint64_t ticks)
+{
+    ProfHist& h = prof_hist[acc];
+    h.n++;
+    h.frame_ticks += ticks;
+    h.bucket[log2_bucket(ticks)]++;
+}
+
+static void
+prof_calibrate(void)
+{
+    using namespace std::chrono;
+    uint64_t dt = prof_ticks() - cal_ticks0;
+    double dns = duration<double, std::nano>(steady_clock::now() - cal_ts0).count();
+    if (dt > 0 && dns > 1.0E8)  // > 100 ms for a sane value
+        ns_per_tick = dns / dt;
+}
+
+static double
+prof_ticks_2_ms(uint64_t ticks)
+{
+    return ticks * ns_per_tick * 1.0E-6;
+}
+
+// percentile in ns, the bucket's midpoint
+static double
+prof_percentile(const ProfHist& h, double p)
+{
+    if (h.n == 0)
+        return 0.0;
+
+    unsigned long long lim = (unsigned long long)(p * h.n), cnt = 0;
+    for (int i = 0; i < kProfBuckets; i++) {
+        cnt += h.bucket[i];
+        if (cnt > lim)
+            return 1.5 * (double)(1ull << i) * ns_per_tick;
+    }
+
+    return 0.0;
+}
+
+// closes a frame
+static float
+prof_frame_cb([[maybe_unused]] float inElapsedSinceLastCall,
+              [[maybe_unused]] float inElapsedTimeSinceLastFlightLoop, [[maybe_unused]] int inCounter,
+              [[maybe_unused]] void *inRefcon)
+{
+    uint64_t total = 0;
+    for (int i = 0; i < kProfNum; i++) {
+        ProfHist& h = prof_hist[i];
+        h.last_frame_us = h.frame_ticks * ns_per_tick * 1.0E-3;
+        total += h.frame_ticks;
+        h.frame_ticks = 0;
+    }
+
+    ProfHist& f = prof_hist[kProfNum];
+    f.n++;
+    f.bucket[log2_bucket(total)]++;
+    f.last_frame_us = total * ns_per_tick * 1.0E-3;
+
+    static int n;
+    if (++n % 256 == 0)
+        prof_calibrate();
+    return -1.0f;
+}
+
+static float
+prof_frame_us_acc(void *ref)
+{
+    return ((ProfHist *)ref)->last_frame_us;
+}
+
+static float
+prof_p50_acc(void *ref)
+{
+    return prof_percentile(*(ProfHist *)ref, 0.5);
+}
+
+static float
+prof_p99_acc(void *ref)
+{
+    return prof_percentile(*(ProfHist *)ref, 0.99);
+}
+
+static void
+prof_init(void)
+{
+    cal_ticks0 = prof_ticks();
+    cal_ts0 = std::chrono::steady_clock::now();
+
+    char name[100];
+    for (auto& h : prof_hist) {
+        snprintf(name, sizeof(name), "opensam/prof/%s/frame_us", h.name);
+        XPLMRegisterDataAccessor(name, xplmType_Float, 0, NULL, NULL,
+                                 prof_frame_us_acc, NULL, NULL, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, &h, NULL);
+        snprintf(name, sizeof(name), "opensam/prof/%s/p50_ns", h.name);
+        XPLMRegisterDataAccessor(name, xplmType_Float, 0, NULL, NULL,
+                                 prof_p50_acc, NULL, NULL, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, &h, NULL);
+        snprintf(name, sizeof(name), "opensam/prof/%s/p99_ns", h.name);
+        XPLMRegisterDataAccessor(name, xplmType_Float, 0, NULL, NULL,
+                                 prof_p99_acc, NULL, NULL, NULL, NULL, NULL,
+                                 NULL, NULL, NULL, NULL, &h, NULL);
+    }
+
+    XPLMRegisterFlightLoopCallback(prof_frame_cb, -1.0f, NULL);
+    log_msg("accessor profiling enabled");
+}
+
+float
+prof_last_frame_us(void)
+{
+    return prof_hist[kProfNum].last_frame_us;
+}
+
+static void
+prof_reset(void)
+{
+    for (auto& h : prof_hist) {
+        h.n = h.frame_ticks = 0;
+        h.last_frame_us = 0.0f;
+        std::fill(h.bucket, h.bucket + kProfBuckets, 0ull);
+    }
+}
+
+void
+prof_log(void)
+{
+    prof_calibrate();
+    log_msg("accessor profile, ns/tick: %0.4f", ns_per_tick);
+    for (auto& h : prof_hist)
+        log_msg("%-14s n: %10llu, p50: %8.0f ns, p90: %8.0f ns, p99: %8.0f ns, p99.9: %8.0f ns",
+                h.name, h.n, prof_percentile(h, 0.5), prof_percentile(h, 0.9),
+                prof_percentile(h, 0.99), prof_percentile(h, 0.999));
+}
+#else
+static void prof_init(void) {}
+static void prof_reset(void) {}
+static double prof_ticks_2_ms([[maybe_unused]] uint64_t ticks) { return 0.0; }
+void prof_log(void) {}
+float prof_last_frame_us(void) { return 0.0f; }
+#endif
@@ -0,0 +1,120 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _OS_STATS_H_
+#define _OS_STATS_H_
+
+#include <cstdint>
+
+// live "opensam/stats/*" datarefs for the stat_* counters
+extern void stats_init(void);
+extern void stats_update(void);     // from the flight loop
+extern void stats_reset(void);
+extern void dump_scenery_cost(void);     // cost per scenery as csv to Output/
+
+//
+// Accessor latency profiling, compile with -DOS_PROFILE.
+// Without it PROF_SCOPE() expands to nothing.
+//
+enum ProfAcc { kProfJwAnim, kProfDgs, kProfSam1, kProfAnim, kProfAutoDrf,
+               kProfNum };
+
+extern void prof_log(void);         // percentiles to Log.txt
+extern float prof_last_frame_us(void);  // accessor total, 0 if not profiling
+
+#ifdef OS_PROFILE
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+static inline uint64_t prof_ticks() { return __rdtsc(); }
+#else
+#include <time.h>
+static inline uint64_t
+prof_ticks()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+extern void prof_record(ProfAcc acc, uint64_t ticks);
+
+struct ProfScope {
+    ProfAcc acc_;
+    uint64_t t0_;
+    ProfScope(ProfAcc acc) : acc_(acc), t0_(prof_ticks()) {}
+    ~ProfScope() { prof_record(acc_, prof_ticks() - t0_); }
+};
+
+// adds the time of the scope to a scenery's cost
+struct ProfScCost {
+    uint64_t& ticks_;
+    uint64_t t0_;
+    ProfScCost(uint64_t& ticks) : ticks_(ticks), t0_(prof_ticks()) {}
+    ~ProfScCost() { ticks_ += prof_ticks() - t0_; }
+};
+
+#define PROF_SCOPE(acc) ProfScope prof_scope_(acc)
+#define PROF_SC_COST(sc) ProfScCost prof_sc_cost_((sc)->cost.ticks)
+#else
+#define PROF_SCOPE(acc)
+#define PROF_SC_COST(sc)
+#endif
+
+//
+// Allocation tracking, compile with -DOS_ALLOC_TRACK.
+// Replaces the plugin's global operator new/delete and attributes each allocation
+// to the innermost active ALLOC_SCOPE().
+//
+enum AllocFamily { kAllocOther, kAllocFlightLoop, kAllocMp, kAllocJw, kAllocDgs,
+                   kAllocJwAcc, kAllocDgsAcc, kAllocAnimAcc, kAllocNum };
+
+extern const char * const alloc_family_str[kAllocNum];
+extern unsigned long long alloc_n[kAllocNum], alloc_bytes[kAllocNum], alloc_free_n;
+
+// allocations of the last / worst flight loop invocation
+extern unsigned long long stat_alloc_loop_n, stat_alloc_loop_bytes, stat_alloc_loop_max_n;
+
+#ifdef OS_ALLOC_TRACK
+extern AllocFamily alloc_cur;
+
+struct AllocScope {
+    AllocFamily prev_;
+    AllocScope(AllocFamily f) : prev_(alloc_cur) { alloc_cur = f; }
+    ~AllocScope() { alloc_cur = prev_; }
+};
+
+// totals of one flight loop invocation
+struct AllocLoopScope {
+    unsigned long long n0_, bytes0_;
+    AllocLoopScope();
+    ~AllocLoopScope();
+};
+
+#define ALLOC_SCOPE(f) AllocScope alloc_scope_(f)
+#define ALLOC_LOOP_SCOPE() AllocLoopScope alloc_loop_scope_
+#else
+#define ALLOC_SCOPE(f)
+#define ALLOC_LOOP_SCOPE()
+#endif
+
+#endif
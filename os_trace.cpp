@@ -0,0 +1,246 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+
+#include <cstdio>
+#include <chrono>
+#include <vector>
+
+#include "openSAM.h"
+#include "os_trace.h"
+
+#ifndef LOCAL_DEBUGSTRING
+#include "XPLMUtilities.h"
+#include "XPLMProcessing.h"
+#endif
+
+static constexpr size_t kTraceMaxEvents = 1000000;  // ~50 MB
+
+struct TraceEvent {
+    const char *name;
+    char ph;            // 'X' complete, 'i' instant, 'C' counter
+    uint64_t ts, dur;
+    double value;
+    std::string arg;
+};
+
+bool trace_active;
+static std::vector<TraceEvent> events;
+static std::chrono::steady_clock::time_point t0;
+static bool overflow;
+
+uint64_t
+trace_ts(void)
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+void
+trace_start(void)
+{
+    events.clear();
+    events.reserve(100000);
+    t0 = std::chrono::steady_clock::now();
+    overflow = false;
+    trace_active = true;
+    log_msg("trace started");
+}
+
+void
+trace_stop(void)
+{
+    trace_active = false;
+    log_msg("trace stopped, %d events", (int)events.size());
+}
+
+static inline bool
+room_left()
+{
+    if (events.size() < kTraceMaxEvents)
+        return true;
+
+    if (! overflow) {
+        log_msg("trace buffer full, further events are dropped");
+        overflow = true;
+    }
+
+    return false;
+}
+
+void
+trace_complete(const char *name, uint64_t ts, const char *arg)
+{
+    if (room_left())
+        events.push_back({name, 'X', ts, trace_ts() - ts, 0.0, arg ? arg : ""});
+}
+
+void
+trace_instant(const char *name, const char *arg)
+{
+    if (! trace_active)
+        return;
+
+    if (room_left())
+        events.push_back({name, 'i', trace_ts(), 0, 0.0, arg ? arg : ""});
+}
+
+void
+trace_counter(const char *name, double value)
+{
+    if (! trace_active)
+        return;
+
+    if (room_left())
+        events.push_back({name, 'C', trace_ts(), 0, value, ""});
+}
+
+static void
+json_string(FILE *f, const std::string& s)
+{
+    fputc('"', f);
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\')
+            fputc('\\', f);
+        if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+bool
+trace_write(const std::string& fn)
+{
+    FILE *f = fopen(fn.c_str(), "w");
+    if (f == NULL) {
+        log_msg("can't create '%s'", fn.c_str());
+        return false;
+    }
+
+    fputs("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n", f);
+    const char *sep = "";
+    for (auto const& e : events) {
+        fprintf(f, "%s{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %llu, \"pid\": 1, \"tid\": 1",
+                sep, e.name, e.ph, (unsigned long long)e.ts);
+        sep = ",\n";
+
+        switch (e.ph) {
+            case 'X':
+                fprintf(f, ", \"dur\": %llu", (unsigned long long)e.dur);
+                break;
+            case 'i':
+                fputs(", \"s\": \"g\"", f);
+                break;
+            case 'C':
+                fprintf(f, ", \"args\": {\"value\": %g}}", e.value);
+                continue;
+        }
+
+        if (! e.arg.empty()) {
+            fputs(", \"args\": {\"arg\": ", f);
+            json_string(f, e.arg);
+            fputc('}', f);
+        }
+        fputc('}', f);
+    }
+
+    fputs("\n]}\n", f);
+    fclose(f);
+    log_msg("trace with %d events written to '%s'", (int)events.size(), fn.c_str());
+    return true;
+}
+
+//==============  X-Plane command + per frame counters ====
+// standalone tools like sam_xml_test have no XPLM
+#ifndef LOCAL_DEBUGSTRING
+static const char *trace_fn = "Output/openSAM_trace.json";
+
+// counters at the last frame
+static unsigned long long acc_prev, dgs_prev, anim_prev, auto_drf_prev;
+
+void
+trace_baseline(void)
+{
+    acc_prev = stat_acc_called;
+    dgs_prev = stat_dgs_acc;
+    anim_prev = stat_anim_acc_called;
+    auto_drf_prev = stat_auto_drf_called;
+}
+
+// accessor bursts as per frame counters
+static float
+trace_frame_cb([[maybe_unused]] float inElapsedSinceLastCall,
+               [[maybe_unused]] float inElapsedTimeSinceLastFlightLoop, [[maybe_unused]] int inCounter,
+               [[maybe_unused]] void *inRefcon)
+{
+    if (! trace_active)
+        return 0.0f;    // unschedule
+
+    trace_counter("jw_anim_acc calls", stat_acc_called - acc_prev);
+    trace_counter("read_dgs_acc calls", stat_dgs_acc - dgs_prev);
+    trace_counter("anim_acc calls", stat_anim_acc_called - anim_prev);
+    trace_counter("auto_drf_acc calls", stat_auto_drf_called - auto_drf_prev);
+    trace_baseline();
+    return -1.0f;
+}
+
+void
+trace_save(void)
+{
+    if (! trace_active)
+        return;
+
+    trace_stop();
+    trace_write(xp_dir + trace_fn);
+}
+
+static int
+cmd_toggle_trace_cb([[maybe_unused]] XPLMCommandRef cmdr, XPLMCommandPhase phase,
+                    [[maybe_unused]] void *ref)
+{
+    if (xplm_CommandBegin != phase)
+        return 0;
+
+    log_msg("cmd toggle_trace");
+    if (trace_active)
+        trace_save();
+    else {
+        trace_start();
+        trace_baseline();
+        XPLMSetFlightLoopCallbackInterval(trace_frame_cb, -1.0f, 1, NULL);
+    }
+
+    return 0;
+}
+
+void
+trace_init(void)
+{
+    XPLMCommandRef trace_cmdr = XPLMCreateCommand("openSAM/toggle_trace", "Start/stop + write trace");
+    XPLMRegisterCommandHandler(trace_cmdr, cmd_toggle_trace_cb, 0, NULL);
+
+    // a trace may already run since startup
+    trace_baseline();
+    XPLMRegisterFlightLoopCallback(trace_frame_cb, trace_active ? -1.0f : 0.0f, NULL);
+}
+#endif
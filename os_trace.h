@@ -0,0 +1,66 @@
+/*
+    openSAM: open source SAM emulator for X Plane
+
+    Copyright (C) 2025  Holger Teutsch
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+    USA
+
+*/
+#ifndef _OS_TRACE_H_
+#define _OS_TRACE_H_
+
+#include <cstdint>
+#include <string>
+
+//
+// Trace events in Chrome's trace event format (chrome://tracing, ui.perfetto.dev).
+// Events are buffered in memory and written by trace_write().
+// Names must be string literals, args are copied.
+//
+extern bool trace_active;
+
+extern void trace_start(void);
+extern void trace_stop(void);
+extern bool trace_write(const std::string& fn);
+
+extern void trace_init(void);       // command openSAM/toggle_trace
+extern void trace_save(void);       // stop a running trace and write it to Output/
+extern void trace_baseline(void);   // for the per frame counters, e.g. after stats_reset()
+
+extern uint64_t trace_ts(void);     // µs since trace_start()
+extern void trace_complete(const char *name, uint64_t ts, const char *arg = nullptr);
+extern void trace_instant(const char *name, const char *arg = nullptr);
+extern void trace_counter(const char *name, double value);
+
+struct TraceScope {
+    const char *name_, *arg_;
+    bool active_;       // trace may be started or stopped within the scope
+    uint64_t ts_{0};
+
+    TraceScope(const char *name, const char *arg = nullptr) : name_(name), arg_(arg), active_(trace_active) {
+        if (active_)
+            ts_ = trace_ts();
+    }
+
+    ~TraceScope() {
+        if (active_ && trace_active)
+            trace_complete(name_, ts_, arg_);
+    }
+};
+
+#define TRACE_SCOPE(...) TraceScope trace_scope_(__VA_ARGS__)
+
+#endif
@@ -22,12 +22,16 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <algorithm>
+#include <initializer_list>
 #include "openSAM.h"
 #include "plane.h"
 #include "samjw.h"
 #include "jwctrl.h"
+#include "os_stats.h"
 
 #include "XPLMDisplay.h"
+#include "XPLMProcessing.h"
 #include "XPStandardWidgets.h"
 
 typedef struct _widget_ctx
@@ -320,3 +324,235 @@ toggle_ui(void) {
         show_widget(&ui_widget_ctx);
     }
 }
+
+//==============  Performance dashboard ====
+//
+// Sampled at 2 Hz by a flight loop that only runs while the window is visible.
+// The graphs are drawn with XPLMDrawString, so no OpenGL is needed.
+//
+static constexpr int kPerfSamples = 60;     // 30 s of history
+static constexpr float kPerfInterval = 0.5f;
+
+enum PerfSeries { kPsPluginUs, kPsJwAcc, kPsDgsAcc, kPsAnimAcc, kPsAutoDrf, kPsLogRate,
+                  kPsMpIdle, kPsMpParked, kPsMpJwMoving, kPsMpDocked,
+                  kPsSceneries, kPsJetways, kPsZcJetways, kPsDoorInfos, kPsNum };
+
+static float perf_hist[kPsNum][kPerfSamples];
+static int perf_head;   // next slot to write
+static unsigned perf_mp_states[Plane::CANT_DOCK + 1];
+
+// counters at the last sample
+static float perf_last_ts;
+static unsigned long long acc_prev, dgs_prev, anim_prev, auto_drf_prev, log_prev;
+
+void
+perf_baseline(void)
+{
+    acc_prev = stat_acc_called;
+    dgs_prev = stat_dgs_acc;
+    anim_prev = stat_anim_acc_called;
+    auto_drf_prev = stat_auto_drf_called;
+    log_prev = log_count();
+    perf_last_ts = now;
+}
+
+static widget_ctx_t perf_widget_ctx;
+static XPWidgetID perf_widget, perf_text[4];
+static XPLMDataRef frame_period_dr;
+
+static float
+perf_sample_cb([[maybe_unused]] float inElapsedSinceLastCall,
+               [[maybe_unused]] float inElapsedTimeSinceLastFlightLoop, [[maybe_unused]] int inCounter,
+               [[maybe_unused]] void *inRefcon)
+{
+    if (! perf_ui_active)
+        return 0.0f;    // unschedule
+
+    float dt = now - perf_last_ts;
+    float frame_period = std::max(XPLMGetDataf(frame_period_dr), 0.001f);
+    float frames = std::max(dt / frame_period, 1.0f);
+
+    float *v = &perf_hist[0][perf_head];
+    v[kPsPluginUs * kPerfSamples] = perf_loop_us / frames + prof_last_frame_us();
+    v[kPsJwAcc * kPerfSamples] = (stat_acc_called - acc_prev) / frames;
+    v[kPsDgsAcc * kPerfSamples] = (stat_dgs_acc - dgs_prev) / frames;
+    v[kPsAnimAcc * kPerfSamples] = (stat_anim_acc_called - anim_prev) / frames;
+    v[kPsAutoDrf * kPerfSamples] = (stat_auto_drf_called - auto_drf_prev) / frames;
+    v[kPsLogRate * kPerfSamples] = (log_count() - log_prev) / std::max(dt, kPerfInterval);
+
+    std::fill(perf_mp_states, perf_mp_states + Plane::CANT_DOCK + 1, 0);
+    mp_state_counts(perf_mp_states);
+    const unsigned *ms = perf_mp_states;
+    v[kPsMpIdle * kPerfSamples] = ms[Plane::IDLE];
+    v[kPsMpParked * kPerfSamples] = ms[Plane::PARKED] + ms[Plane::SELECT_JWS] + ms[Plane::CAN_DOCK]
+                                    + ms[Plane::CANT_DOCK];
+    v[kPsMpJwMoving * kPerfSamples] = ms[Plane::DOCKING] + ms[Plane::UNDOCKING];
+    v[kPsMpDocked * kPerfSamples] = ms[Plane::DOCKED];
+
+    unsigned n_jws = 0;
+    for (auto sc : sceneries)
+        n_jws += sc->sam_jws.size();
+
+    v[kPsSceneries * kPerfSamples] = sceneries.size();
+    v[kPsJetways * kPerfSamples] = n_jws;
+    v[kPsZcJetways * kPerfSamples] = zc_jws.size();
+    v[kPsDoorInfos * kPerfSamples] = door_info_table.size();
+    perf_head = (perf_head + 1) % kPerfSamples;
+
+    perf_loop_us = 0.0;
+    perf_baseline();
+
+    // text lines
+    char line[200];
+    snprintf(line, sizeof(line), "sceneries: %d, jetways: %u, zc jetways: %d, door infos: %u",
+             (int)sceneries.size(), n_jws, (int)zc_jws.size(), door_info_table.size());
+    XPSetWidgetDescriptor(perf_text[0], line);
+
+    int len = snprintf(line, sizeof(line), "MP planes:");
+    for (int i = Plane::IDLE; i <= Plane::CANT_DOCK; i++)
+        if (perf_mp_states[i])
+            len += snprintf(line + len, sizeof(line) - len, " %s: %u", Plane::state_str_[i], perf_mp_states[i]);
+    XPSetWidgetDescriptor(perf_text[1], line);
+
+    snprintf(line, sizeof(line), "log: %llu msgs, %llu dropped", log_count(), log_dropped());
+    XPSetWidgetDescriptor(perf_text[2], line);
+
+    snprintf(line, sizeof(line), "my_plane dref reads: %llu", stat_my_dr_read);
+    XPSetWidgetDescriptor(perf_text[3], line);
+
+    return kPerfInterval;
+}
+
+// one graph of some series, scaled to the max of them
+static void
+draw_graph(int l, int b, int w, int h, const char *title,
+           std::initializer_list<PerfSeries> series, const float (*colors)[3])
+{
+    static float white[3] = {1.0f, 1.0f, 1.0f};
+    float vmax = 1.0f;
+    for (auto s : series)
+        for (int i = 0; i < kPerfSamples; i++)
+            vmax = std::max(vmax, perf_hist[s][i]);
+
+    char label[80];
+    snprintf(label, sizeof(label), "%s (max %0.0f)", title, vmax);
+    XPLMDrawString(white, l, b + h + 4, label, NULL, xplmFont_Proportional);
+
+    int ic = 0;
+    for (auto s : series) {
+        for (int i = 0; i < kPerfSamples; i++) {
+            float v = perf_hist[s][(perf_head + i) % kPerfSamples];  // oldest first
+            int x = l + i * w / kPerfSamples;
+            int y = b + (int)(v / vmax * h);
+            XPLMDrawString((float *)colors[ic], x, y, (char *)".", NULL, xplmFont_Basic);
+        }
+        ic++;
+    }
+}
+
+static int
+perf_graph_cb(XPWidgetMessage msg, XPWidgetID widget_id,
+              [[maybe_unused]] intptr_t param1, [[maybe_unused]] intptr_t param2)
+{
+    if (msg != xpMsg_Draw)
+        return 0;
+
+    static const float colors[][3] = {
+        {0.2f, 1.0f, 0.2f}, {1.0f, 0.8f, 0.2f}, {0.3f, 0.6f, 1.0f}, {1.0f, 0.3f, 0.3f}
+    };
+
+    int l, t, r, b;
+    XPGetWidgetGeometry(widget_id, &l, &t, &r, &b);
+    int gh = (t - b) / 5 - 20;
+
+    draw_graph(l, t - gh - 15, r - l, gh, "plugin us/frame", {kPsPluginUs}, colors);
+    draw_graph(l, t - 2 * gh - 35, r - l, gh, "acc calls/frame: jw dgs anim auto",
+               {kPsJwAcc, kPsDgsAcc, kPsAnimAcc, kPsAutoDrf}, colors);
+    draw_graph(l, t - 3 * gh - 55, r - l, gh, "log msgs/s", {kPsLogRate}, colors);
+    draw_graph(l, t - 4 * gh - 75, r - l, gh, "MP planes: idle parked jw_moving docked",
+               {kPsMpIdle, kPsMpParked, kPsMpJwMoving, kPsMpDocked}, colors);
+    draw_graph(l, t - 5 * gh - 95, r - l, gh, "working set: sceneries jetways zc_jetways door_infos",
+               {kPsSceneries, kPsJetways, kPsZcJetways, kPsDoorInfos}, colors);
+    return 1;
+}
+
+static void
+close_perf_ui()
+{
+    XPGetWidgetGeometry(perf_widget_ctx.widget, &perf_widget_ctx.l, &perf_widget_ctx.t, NULL, NULL);
+    XPHideWidget(perf_widget_ctx.widget);
+    perf_ui_active = false;     // sampler unschedules itself
+}
+
+static int
+perf_widget_cb(XPWidgetMessage msg, [[maybe_unused]] XPWidgetID widget_id,
+               [[maybe_unused]] intptr_t param1, [[maybe_unused]] intptr_t param2)
+{
+    if (msg == xpMessage_CloseButtonPushed) {
+        close_perf_ui();
+        return 1;
+    }
+
+    return 0;
+}
+
+static void
+create_perf_ui()
+{
+    int xl, yr;
+    XPLMGetScreenBoundsGlobal(&xl, &yr, NULL, NULL);
+
+    static const int margin = 20;
+    int left = xl + 300;
+    int top = yr - 100;
+    int width = 460;
+    int height = 640;
+
+    perf_widget_ctx.l = left;
+    perf_widget_ctx.t = top;
+    perf_widget_ctx.w = width;
+    perf_widget_ctx.h = height;
+
+    perf_widget = XPCreateWidget(left, top, left + width, top - height,
+                                 0, "openSAM performance", 1, NULL, xpWidgetClass_MainWindow);
+    perf_widget_ctx.widget = perf_widget;
+    XPSetWidgetProperty(perf_widget, xpProperty_MainWindowHasCloseBoxes, 1);
+    XPAddWidgetCallback(perf_widget, perf_widget_cb);
+
+    top -= 30;
+    for (int i = 0; i < 4; i++) {
+        perf_text[i] = XPCreateWidget(left + margin, top, left + width - margin, top - 15,
+                                      1, "", 0, perf_widget, xpWidgetClass_Caption);
+        top -= 15;
+    }
+
+    top -= 10;
+    XPCreateCustomWidget(left + margin, top, left + width - margin, top - (height - 110),
+                         1, "", 0, perf_widget, perf_graph_cb);
+
+    frame_period_dr = XPLMFindDataRef("sim/operation/misc/frame_rate_period");
+    XPLMRegisterFlightLoopCallback(perf_sample_cb, 0.0f, NULL);
+}
+
+void
+toggle_perf_ui(void)
+{
+    if (perf_widget == NULL)
+        create_perf_ui();
+
+    if (XPIsWidgetVisible(perf_widget)) {
+        close_perf_ui();
+        return;
+    }
+
+    // no history and deltas from a previous opening
+    for (auto& h : perf_hist)
+        std::fill(h, h + kPerfSamples, 0.0f);
+    perf_head = 0;
+    perf_baseline();
+
+    perf_loop_us = 0.0;
+    perf_ui_active = true;
+    XPLMSetFlightLoopCallbackInterval(perf_sample_cb, -1.0f, 1, NULL);
+    show_widget(&perf_widget_ctx);
+}
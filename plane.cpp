@@ -33,6 +33,8 @@
 
 #include "plane.h"
 #include "samjw.h"
+#include "os_trace.h"
+#include "os_stats.h"
 
 int Plane::id_base_;
 
@@ -105,6 +107,8 @@ Plane::jw_state_machine()
     if (state_machine_next_ts_ > ::now)         // action is not due
         return state_machine_next_ts_ - ::now;
 
+    TRACE_SCOPE("jw_state_machine");
+    ALLOC_SCOPE(kAllocJw);
     State new_state{state_};
 
     if (state_ > IDLE && check_teleportation()) {
@@ -120,7 +124,7 @@ Plane::jw_state_machine()
         SamJw::reset_all();
     }
 
-    unsigned n_done;
+    unsigned n_done, n_held;
 
     switch (state_) {
         case IDLE:
@@ -219,11 +223,21 @@ Plane::jw_state_machine()
         case DOCKING:
 
             n_done = 0;
+            n_held = 0;
             for (auto & ajw : active_jws_) {
-                if (ajw.dock_drive())
+                if (ajw.hold_for_geometry(*this))
+                    n_held++;
+                else if (ajw.dock_drive())
                     n_done++;
             }
 
+            // nothing moved yet so a departing plane just lets go
+            if (n_held == active_jws_.size() && beacon_on_) {
+                log_msg("pid=%d, DOCKING held for library geometry and beacon goes on", id_);
+                new_state = IDLE;
+                break;
+            }
+
             if (n_done == active_jws_.size()) {
                 if (call_post_dock_cmd()) {
                     XPLMCommandRef cmdr = XPLMFindCommand("openSAM/post_dock");
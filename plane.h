@@ -72,7 +72,7 @@ class Plane {
     virtual void memorize_parked_pos() {} // for teleportation detection
 
     // general state
-    State state() { return state_; }
+    State state() const { return state_; }
     std::string& icao() { return icao_; }
 
     // position
@@ -133,6 +133,27 @@ class MyPlane : public Plane {
 
     float elevation_;
 
+    // Dataref values read by update(). Each field is refreshed according to
+    // a sampling plan that depends on our state and the DGS state.
+    enum SampleField { kSmplPos, kSmplGear, kSmplEngines, kSmplBeacon,
+                       kSmplParkbrake, kSmplElevation, kSmplNum };
+    struct DrefSample {
+        float x, y, z, psi;
+        float gear_fnrml;
+        int n_eng, eng_running[8];
+        int beacon;
+        float parkbrake;
+        float elevation;
+        float next_ts[kSmplNum];    // next read of the field
+    } smpl_{};
+    unsigned smpl_ref_gen_{0};
+    float smpl_ts0_{-1.0f};         // first update() for stats
+    bool smpl_busy_{false};         // DGS tracking or jetway states, fast sampling
+
+    bool jw_busy() const { return (SELECT_JWS <= state_ && state_ <= UNDOCKING) || state_ == PARKED; }
+    float sample_period(SampleField f) const;
+    bool sample_due(SampleField f);
+
   public:
     static void init();         // call once
 
@@ -147,10 +168,15 @@ class MyPlane : public Plane {
     void plane_loaded();        // called from XPLM_MSG_PLANE_LOADED handler
     void livery_loaded();       // called from  XPLM_MSG_LIVERY_LOADED handler
 
+    static void load_acf_policy();  // acf_*.txt exception files
+    void apply_acf_policy();
+    bool use_engines_on() const { return use_engines_on_; }
+
     void reset_beacon();
 
     // update internal state
     void update();
+    void log_sample_stats() const;
 
     void memorize_parked_pos() override ; // for teleportation detection
     bool check_teleportation() override;
@@ -182,6 +208,10 @@ class MyPlane : public Plane {
     bool undock_requested() override;
     bool toggle_requested() override;
 
+    // pending requests as kRecReq* mask for session recording and replay
+    unsigned requests() const;
+    void set_requests(unsigned req);
+
     // dataref accessors
     static int jw_status_acc(void *ref);
     static int jw_door_status_acc(XPLMDataRef ref, int *values, int ofs, int n);
@@ -88,7 +88,7 @@ read_wav(const std::string& fname, Sound& sound)
 
     // loop over chunks and find first data chunk
     while(1 == fread(&chunk, sizeof(chunk), 1, f)) {
-        printf("chunk '%s' %d\n", chunk.id, chunk.size);
+        log_debug("chunk '%.4s' %d", chunk.id, (int)chunk.size);
         if (0 == memcmp(chunk.id, "data", 4)) {
             void *data = malloc(chunk.size);
             if (NULL == data) {
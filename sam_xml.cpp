@@ -40,6 +40,7 @@
 #include "samjw.h"
 #include "os_dgs.h"
 #include "os_anim.h"
+#include "os_trace.h"
 
 // context for element handlers
 typedef struct _expat_ctx {
@@ -57,6 +58,7 @@ typedef struct _expat_ctx {
 std::vector<Scenery *> sceneries;
 
 SamJw sam3_lib_jw[MAX_SAM3_LIB_JW + 1];
+int n_sam3_lib_jw;
 
 std::vector<SamDrf*> sam_drfs;
 
@@ -197,6 +199,7 @@ start_element(void *user_data, const XML_Char *name, const XML_Char **attr) {
         }
 
         sam3_lib_jw[sam_jw.id] = sam_jw;
+        n_sam3_lib_jw++;
         return;
     }
 
@@ -512,6 +515,7 @@ collect_sam_xml(const SceneryPacks &scp)
     }
 
     for (auto sc_path : scp.sc_paths) {
+        TRACE_SCOPE("scenery", sc_path.c_str());
         Scenery* sc = new Scenery();
         if (!parse_sam_xml(sc_path + "sam.xml", sc)) {
             delete(sc);
@@ -20,33 +20,183 @@
 
 */
 
+//
+// Load benchmark for sam.xml/apt.dat collection, the bulk of openSAM's startup time.
+//
+//   sam_xml_test [-q] [-d] [-w] [-r repeats] [-g packs[,jetways[,stands[,apt_padding]]]] xp_dir
+//
+//  -g  generate a synthetic Custom Scenery tree below xp_dir first
+//  -r  number of repeats, each repeat is a cold run followed by a warm run
+//  -w  warm runs only
+//  -d  dump what was collected, no timing
+//  -q  no log messages
+//
+// A cold run evicts the collected files from the page cache first
+// (posix_fadvise, Linux only; dentries and inodes stay cached).
+// Per run wall time, bytes read, read syscalls (/proc/self/io) and the peak RSS are
+// written as JSON to stdout.
+//
+
 #include <cstddef>
 #include <cstdlib>
 #include <cstdio>
 #include <cstring>
-#include <iostream>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
 
 #include "openSAM.h"
 #include "os_dgs.h"
 #include "samjw.h"
 #include "os_anim.h"
+#include "synth_world.h"
 
-std::string xp_dir{"E:/X-Plane-12"};
+std::string xp_dir;
 
-int
-main(int argc, char **argv) {
+extern FILE *log_local_fp;      // XPLMDebugString() of log_msg.cpp with LOCAL_DEBUGSTRING
+
+struct IoStat {
+    unsigned long long rchar, syscr, read_bytes;
+};
+
+// counters of /proc/self/io, zero elsewhere
+static IoStat
+io_stat()
+{
+    IoStat io{};
+    std::ifstream f("/proc/self/io");
+    std::string key;
+    unsigned long long val;
+    while (f >> key >> val) {
+        if (key == "rchar:")
+            io.rchar = val;
+        else if (key == "syscr:")
+            io.syscr = val;
+        else if (key == "read_bytes:")
+            io.read_bytes = val;
+    }
+    return io;
+}
+
+// peak RSS in kB, since the last reset_peak_rss() if supported
+static long
+peak_rss_kb()
+{
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while (std::getline(f, line))
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return atol(line.c_str() + 6);
+
+#ifdef __linux__
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        return ru.ru_maxrss;
+#endif
+    return 0;
+}
+
+static void
+reset_peak_rss()
+{
+    std::ofstream f("/proc/self/clear_refs");
+    if (f.is_open())
+        f << "5";
+}
+
+// drop the files of a load from the page cache
+static bool
+evict(const std::string& dir)
+{
+#ifdef __linux__
+    std::vector<std::string> files{dir + "/Custom Scenery/scenery_packs.ini"};
+    SceneryPacks scp(dir);
+    files.push_back(scp.openSAM_Library_path + "sam.xml");
+    if (scp.SAM_Library_path.size() > 0)
+        files.push_back(scp.SAM_Library_path + "libraryjetways.xml");
+
+    for (auto& p : scp.sc_paths) {
+        files.push_back(p + "sam.xml");
+        files.push_back(p + "Earth nav data/apt.dat");
+    }
+
+    for (auto& fn : files) {
+        int fd = open(fn.c_str(), O_RDONLY);
+        if (fd < 0)
+            continue;
+        fdatasync(fd);      // dirty pages can't be dropped
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+static void
+free_sceneries()
+{
+    for (auto sc : sceneries) {
+        for (auto jw : sc->sam_jws) delete jw;
+        for (auto stand : sc->stands) delete stand;
+        for (auto obj : sc->sam_objs) delete obj;
+        for (auto anim : sc->sam_anims) delete anim;
+        delete sc;
+    }
+    sceneries.clear();
+
+    for (auto drf : sam_drfs)
+        delete drf;
+    sam_drfs.clear();
+}
+
+struct Run {
+    bool cold;
+    double ms;
+    IoStat io;
+    long peak_rss_kb;
+    int n_sceneries;
+};
 
-    std::cout << "sam_xml_test starting\n";
+static bool
+load(bool cold, Run& run)
+{
+    free_sceneries();
+    run.cold = cold && evict(xp_dir);
+    reset_peak_rss();
+    IoStat io0 = io_stat();
 
+    auto t0 = std::chrono::steady_clock::now();
     try {
         SceneryPacks scp(xp_dir);
         collect_sam_xml(scp);
-        log_msg("%d sceneries with sam jetways found", (int)sceneries.size());
     } catch (const OsEx& ex) {
         log_msg("fatal error: '%s', bye!", ex.what());
-        return 0;   // bye
+        return false;
     }
+    auto t1 = std::chrono::steady_clock::now();
 
+    IoStat io1 = io_stat();
+    run.ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    run.io = IoStat{io1.rchar - io0.rchar, io1.syscr - io0.syscr, io1.read_bytes - io0.read_bytes};
+    run.peak_rss_kb = peak_rss_kb();
+    run.n_sceneries = sceneries.size();
+    log_msg("%d sceneries with sam jetways found", run.n_sceneries);
+    return true;
+}
+
+static void
+dump()
+{
     printf("\n%d sceneries collected\n", (int)sceneries.size());
 
     printf("%d datarefs collected\n", (int)sam_drfs.size());
@@ -100,6 +250,128 @@ main(int argc, char **argv) {
         }
         puts("\n");
     }
+}
 
-	return (0);
+static std::string
+json_str(const std::string& s)
+{
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            r += '\\';
+        r += c;
+    }
+    return r;
+}
+
+static void
+summary(const std::vector<Run>& runs, bool cold)
+{
+    std::vector<double> ms;
+    for (auto& r : runs)
+        if (r.cold == cold)
+            ms.push_back(r.ms);
+
+    if (ms.empty()) {
+        printf("null");
+        return;
+    }
+
+    std::sort(ms.begin(), ms.end());
+    printf("{\"runs\": %d, \"min_ms\": %0.3f, \"median_ms\": %0.3f, \"max_ms\": %0.3f}",
+           (int)ms.size(), ms.front(), ms[ms.size() / 2], ms.back());
+}
+
+static void
+usage()
+{
+    fprintf(stderr, "usage: sam_xml_test [-q] [-d] [-w] [-r repeats] "
+                    "[-g packs[,jetways[,stands[,apt_padding]]]] xp_dir\n");
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    bool dump_it = false, warm_only = false;
+    int repeats = 3;
+    bool generate = false;
+    SynthWorldCfg cfg;
+
+    log_local_fp = stderr;      // stdout is for the JSON
+
+    int ai;
+    for (ai = 1; ai < argc && argv[ai][0] == '-'; ai++) {
+        if (strcmp(argv[ai], "-q") == 0)
+            log_local_fp = nullptr;
+        else if (strcmp(argv[ai], "-d") == 0)
+            dump_it = true;
+        else if (strcmp(argv[ai], "-w") == 0)
+            warm_only = true;
+        else if (strcmp(argv[ai], "-r") == 0 && ai + 1 < argc)
+            repeats = std::max(1, atoi(argv[++ai]));
+        else if (strcmp(argv[ai], "-g") == 0 && ai + 1 < argc) {
+            generate = true;
+            int v[4] = {cfg.n_sceneries, cfg.n_jetways, cfg.n_stands, cfg.apt_padding};
+            sscanf(argv[++ai], "%d,%d,%d,%d", &v[0], &v[1], &v[2], &v[3]);
+            cfg.n_sceneries = v[0]; cfg.n_jetways = v[1]; cfg.n_stands = v[2]; cfg.apt_padding = v[3];
+            cfg.n_dgs = 0;
+        } else
+            usage();
+    }
+
+    if (ai != argc - 1)
+        usage();
+
+    xp_dir = argv[ai];
+    if (xp_dir.back() != '/')
+        xp_dir += '/';
+
+    if (generate) {
+        log_msg("generating %d packs with %d jetways, %d stands, %d apt.dat filler lines in '%s'",
+                cfg.n_sceneries, cfg.n_jetways, cfg.n_stands, cfg.apt_padding, xp_dir.c_str());
+        if (!synth_world_write(synth_world_generate(cfg), xp_dir, "")) {
+            log_msg("can't generate synthetic world");
+            return 1;
+        }
+    }
+
+    if (dump_it)
+        repeats = 1;
+
+    std::vector<Run> runs;
+    for (int i = 0; i < repeats; i++) {
+        for (int cold = warm_only ? 0 : 1; cold >= 0; cold--) {
+            Run run;
+            if (!load(cold, run))
+                return 1;
+            runs.push_back(run);
+        }
+    }
+
+    if (dump_it) {
+        if (log_local_fp)
+            log_local_fp = stdout;
+        dump();
+        return 0;
+    }
+
+    printf("{\"benchmark\": \"load\", \"xp_dir\": \"%s\",\n", json_str(xp_dir).c_str());
+    if (generate)
+        printf(" \"generated\": {\"packs\": %d, \"jetways\": %d, \"stands\": %d, \"apt_padding\": %d},\n",
+               cfg.n_sceneries, cfg.n_jetways, std::max(cfg.n_stands, cfg.n_jetways), cfg.apt_padding);
+    printf(" \"runs\": [");
+    for (unsigned i = 0; i < runs.size(); i++) {
+        const Run& r = runs[i];
+        printf("%s\n  {\"mode\": \"%s\", \"ms\": %0.3f, \"sceneries\": %d, \"rchar\": %llu, \"syscr\": %llu, "
+               "\"read_bytes\": %llu, \"peak_rss_kb\": %ld}",
+               i ? "," : "", r.cold ? "cold" : "warm", r.ms, r.n_sceneries,
+               r.io.rchar, r.io.syscr, r.io.read_bytes, r.peak_rss_kb);
+    }
+    printf("\n ],\n \"cold\": ");
+    summary(runs, true);
+    printf(",\n \"warm\": ");
+    summary(runs, false);
+    printf("\n}\n");
+    return 0;
 }
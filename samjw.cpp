@@ -31,6 +31,9 @@
 
 #include "os_dgs.h"
 #include "plane.h"
+#include "os_stats.h"
+#include "os_trace.h"
+#include "os_rec.h"
 
 static const float SAM_2_OBJ_MAX = 2.5;     // m, max delta between coords in sam.xml and object
 static const float SAM_2_OBJ_HDG_MAX = 5;   // °, likewise for heading
@@ -76,7 +79,7 @@ SamJw::fill_library_values(int id)
 
     library_id = id;
 
-    log_msg("filling in library data for '%s', id: %d", name, id);
+    log_cat(kLogZc, "filling in library data for '%s', id: %d", name, id);
 
     const SamJw *ljw = &sam3_lib_jw[id];
 
@@ -172,7 +175,7 @@ configure_zc_jw(int id, float obj_x, float obj_z, float obj_y, float obj_psi)
         // randomize
         float delta_r = (0.2f + 0.8f * (0.01f * (rand() % 100))) * delta;
         jw->initialRot2 = delta_r;
-        log_msg("jw->psi: %0.1f, stand->hdgt: %0.1f, delta: %0.1f, initialRot2: %0.1f",
+        log_cat(kLogZc, "jw->psi: %0.1f, stand->hdgt: %0.1f, delta: %0.1f, initialRot2: %0.1f",
                 jw->psi, stand->hdgt, delta, jw->initialRot2);
     } else
         jw->initialRot2 = 5.0f;
@@ -187,11 +190,56 @@ configure_zc_jw(int id, float obj_x, float obj_z, float obj_y, float obj_psi)
 
     zc_jws.push_back(jw);
 
-    log_msg("added to zc table stand: '%s', global: x: %5.3f, z: %5.3f, y: %5.3f, psi: %4.1f, initialRot2: %0.1f",
+    log_cat(kLogZc, "added to zc table stand: '%s', global: x: %5.3f, z: %5.3f, y: %5.3f, psi: %4.1f, initialRot2: %0.1f",
             stand ? stand->id : "<NULL>", jw->x, jw->z, jw->y, jw->psi, jw->initialRot2);
     return jw;
 }
 
+//
+// compute local coordinates of the jetway from sam.xml's lat/lon
+//
+bool
+SamJw::xml_to_local()
+{
+    // we must iterate to get the elevation of the jetway
+    //
+    // this stuff runs once when a jw in a scenery comes in sight
+    // or is localized by the background pass so it should not be too costly
+    //
+    double  x, y ,z;
+    XPLMWorldToLocal(latitude, longitude, 0.0, &x, &y, &z);
+    REC_W2L(latitude, longitude, 0.0, x, y, z);
+    XPLMProbeResult res = XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo);
+    REC_PROBE(x, y, z, res, probeinfo);
+    if (xplm_ProbeHitTerrain != res) {
+        log_msg("terrain probe failed???");
+        return false;
+    }
+
+    // xform back to world to get an approximation for the elevation
+    double lat, lon, elevation;
+    XPLMLocalToWorld(probeinfo.locationX, probeinfo.locationY, probeinfo.locationZ,
+                     &lat, &lon, &elevation);
+    REC_L2W(probeinfo.locationX, probeinfo.locationY, probeinfo.locationZ, lat, lon, elevation);
+    //log_msg("elevation: %0.2f", elevation);
+
+    // and again to local with SAM's lat/lon and the approx elevation
+    XPLMWorldToLocal(latitude, longitude, elevation, &x, &y, &z);
+    REC_W2L(latitude, longitude, elevation, x, y, z);
+    res = XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo);
+    REC_PROBE(x, y, z, res, probeinfo);
+    if (xplm_ProbeHitTerrain != res) {
+        log_msg("terrain probe 2 failed???");
+        return false;
+    }
+
+    xml_x = probeinfo.locationX;
+    xml_y = probeinfo.locationY;
+    xml_z = probeinfo.locationZ;
+    xml_ref_gen = ref_gen;
+    return true;
+}
+
 // check for shift of reference frame
 void
 check_ref_frame_shift()
@@ -205,6 +253,7 @@ check_ref_frame_shift()
         lon_ref = lon_r;
         ref_gen++;
         log_msg("reference frame shift");
+        trace_instant("reference frame shift");
     }
 
     if (zc_ref_gen < ref_gen) {
@@ -231,6 +280,8 @@ check_ref_frame_shift()
 static float
 jw_anim_acc(void *ref)
 {
+    PROF_SCOPE(kProfJwAnim);
+    ALLOC_SCOPE(kAllocJwAcc);
     stat_acc_called++;
 
     float lat = my_plane.lat();
@@ -253,50 +304,25 @@ jw_anim_acc(void *ref)
         // cheap check against bounding box
         if (! sc->in_bbox(lat, lon)) {
             stat_sc_far_skip++;
+            sc->cost.sc_far_skip++;
             continue;
         }
 
+        PROF_SC_COST(sc);
         for (auto jw_ : sc->sam_jws) {
             // cheap check against bounding box
             if (lat < jw_->bb_lat_min || lat > jw_->bb_lat_max
                 || RA(lon - jw_->bb_lon_min) < 0 || RA(lon - jw_->bb_lon_max) > 0) {
                 stat_far_skip++;
+                sc->cost.far_skip++;
                 continue;
             }
 
             if (fabsf(RA(jw_->heading - obj_psi)) > SAM_2_OBJ_HDG_MAX)
                 continue;
 
-            if (jw_->xml_ref_gen < ref_gen) {
-                // we must iterate to get the elevation of the jetway
-                //
-                // this stuff runs once when a jw in a scenery comes in sight
-                // so it should not be too costly
-                //
-                double  x, y ,z;
-                XPLMWorldToLocal(jw_->latitude, jw_->longitude, 0.0, &x, &y, &z);
-                if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
-                    log_msg("terrain probe failed???");
-                    return 0.0f;
-                }
-
-                // xform back to world to get an approximation for the elevation
-                double lat, lon, elevation;
-                XPLMLocalToWorld(probeinfo.locationX, probeinfo.locationY, probeinfo.locationZ,
-                                 &lat, &lon, &elevation);
-                //log_msg("elevation: %0.2f", elevation);
-
-                // and again to local with SAM's lat/lon and the approx elevation
-                XPLMWorldToLocal(jw_->latitude, jw_->longitude, elevation, &x, &y, &z);
-                if (xplm_ProbeHitTerrain != XPLMProbeTerrainXYZ(probe_ref, x, y, z, &probeinfo)) {
-                    log_msg("terrain probe 2 failed???");
-                    return 0.0f;
-                }
-
-                jw_->xml_x = probeinfo.locationX;
-                jw_->xml_z = probeinfo.locationZ;
-                jw_->xml_ref_gen = ref_gen;
-            }
+            if (jw_->xml_ref_gen < ref_gen && !jw_->xml_to_local())
+                return 0.0f;
 
             if (fabs(obj_x - jw_->xml_x) <= SAM_2_OBJ_MAX && fabs(obj_z - jw_->xml_z) <= SAM_2_OBJ_MAX) {
                 // have a match
@@ -307,14 +333,27 @@ jw_anim_acc(void *ref)
                     jw_->z = obj_z;
                     jw_->y = obj_y;
                     jw_->psi = obj_psi;
+
+                    // for later localizations from sam.xml
+                    jw_->obj_dx = obj_x - jw_->xml_x;
+                    jw_->obj_dy = obj_y - jw_->xml_y;
+                    jw_->obj_dz = obj_z - jw_->xml_z;
+                    jw_->obj_dpsi = RA(obj_psi - jw_->heading);
+                    jw_->drawn = true;
+
+                    // before it can be docked
+                    if (id > 0)
+                        jw_->fill_library_values(id);
                 }
 
                 stat_jw_match++;
+                sc->cost.jw_match++;
                 jw = jw_;
                 goto out;   // of nested loops
             }
 
             stat_near_skip++;
+            sc->cost.near_skip++;
         }
     }
 
@@ -377,6 +416,80 @@ jw_anim_acc(void *ref)
     return 0.0f;
 }
 
+//
+// Background pass that localizes the jetways of sceneries around the plane
+// from sam.xml values. So MP planes can dock to jetways that were not yet drawn.
+//
+// Terrain probes are the cost so only kLocalizePerRun jetways are done per call.
+//
+float
+jw_localize_pass()
+{
+    static constexpr int kLocalizePerRun = 16;
+    static constexpr float kRescanInterval = 10.0f;  // (s) to pick up sceneries coming in range
+
+    static unsigned int pass_ref_gen;
+    static float next_pass_ts;
+    static size_t sc_idx, jw_idx;
+
+    check_ref_frame_shift();
+
+    // start a new pass
+    if (pass_ref_gen != ref_gen || (sc_idx >= sceneries.size() && now > next_pass_ts)) {
+        pass_ref_gen = ref_gen;
+        sc_idx = jw_idx = 0;
+    }
+
+    if (sc_idx >= sceneries.size())     // pass is done, wait for the next one
+        return std::max(next_pass_ts - now, 0.5f);
+
+    float lat = my_plane.lat();
+    float lon = my_plane.lon();
+
+    int n_localized = 0;
+    while (sc_idx < sceneries.size()) {
+        Scenery *sc = sceneries[sc_idx];
+        if (jw_idx == 0 && ! sc->in_bbox(lat, lon)) {
+            sc_idx++;
+            continue;
+        }
+
+        if (jw_idx >= sc->sam_jws.size()) {
+            sc_idx++;
+            jw_idx = 0;
+            continue;
+        }
+
+        SamJw *jw = sc->sam_jws[jw_idx];
+        if (jw->obj_ref_gen == ref_gen || jw->loc_ref_gen == ref_gen
+            || lat < jw->bb_lat_min || lat > jw->bb_lat_max
+            || RA(lon - jw->bb_lon_min) < 0 || RA(lon - jw->bb_lon_max) > 0) {
+            jw_idx++;
+            continue;
+        }
+
+        if (n_localized >= kLocalizePerRun)
+            return -1.0f;   // next frame
+
+        jw_idx++;
+        n_localized++;
+        if (jw->xml_ref_gen < ref_gen && !jw->xml_to_local())
+            continue;
+
+        // the offset to the drawn object is invariant to shifts of the reference frame
+        jw->x = jw->xml_x + jw->obj_dx;
+        jw->y = jw->xml_y + jw->obj_dy;
+        jw->z = jw->xml_z + jw->obj_dz;
+        jw->psi = RA(jw->heading + jw->obj_dpsi);
+        jw->loc_ref_gen = ref_gen;
+        stat_jw_localized++;
+    }
+
+    log_msg("jetway localization pass done, total localized: %llu", stat_jw_localized);
+    next_pass_ts = now + kRescanInterval;
+    return kRescanInterval;
+}
+
 // static method, reset all jetways
 void
 SamJw::reset_all()
@@ -400,14 +513,14 @@ jw_init()
         name[99] = '\0';
         snprintf(name, sizeof(name) - 1, "sam/jetway/%s", dr_name_jw[drc]);
         XPLMRegisterDataAccessor(name, xplmType_Float, 0, NULL,
-                                 NULL, jw_anim_acc, NULL, NULL, NULL, NULL, NULL, NULL,
+                                 NULL, REC_ACC(jw_anim_acc, kRecJw), NULL, NULL, NULL, NULL, NULL, NULL,
                                  NULL, NULL, NULL, (void *)(uint64_t)drc, NULL);
 
         for (int i = 1; i <= MAX_SAM3_LIB_JW; i++) {
             snprintf(name, sizeof(name) - 1, "sam/jetway/%02d/%s", i, dr_name_jw[drc]);
             uint64_t ctx = (uint64_t)i << 32|(uint64_t)drc;
             XPLMRegisterDataAccessor(name, xplmType_Float, 0, NULL,
-                                     NULL, jw_anim_acc, NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, REC_ACC(jw_anim_acc, kRecJw), NULL, NULL, NULL, NULL, NULL, NULL,
                                      NULL, NULL, NULL, (void *)ctx, NULL);
         }
 
@@ -24,6 +24,8 @@
 
 static const float FAR_SKIP = 5000;     // (m) don't consider jetways farther away
 
+extern int n_sam3_lib_jw;   // # of library jetway sets loaded from SAM_Library
+
 struct SamJw  {
   public:
     int is_zc_jw;   // is a zero config jw
@@ -37,7 +39,10 @@ struct SamJw  {
     // values from the actually drawn object
     float x, y, z, psi;
     unsigned int obj_ref_gen;
+    unsigned int loc_ref_gen;   // not yet drawn but x, y, z, psi localized from sam.xml
     int library_id;
+    bool drawn;                 // drawn at least once, library_id and obj_d* are valid
+    float obj_dx, obj_dy, obj_dz, obj_dpsi; // drawn object - sam.xml, applied when localizing
 
     // values fed to the datarefs
     float rotate1, rotate2, rotate3, extent, wheels,
@@ -76,6 +81,14 @@ struct SamJw  {
 
     void fill_library_values(int id);
     Stand* find_stand();
+    bool xml_to_local();    // compute xml_x, xml_y, xml_z
+
+    // A library jetway gets its geometry from the library set on the first draw.
+    // Until then it can't be told from a custom one and only has the sam.xml values.
+    bool has_geometry() const { return drawn || is_zc_jw || n_sam3_lib_jw == 0; }
+
+    // dockable if drawn or localized in the current reference frame
+    bool dockable() const { return obj_ref_gen == ref_gen || loc_ref_gen == ref_gen; }
 
     static void reset_all();
 };
@@ -88,4 +101,5 @@ extern SamJw sam3_lib_jw[];
 
 extern void jw_init(void);
 void check_ref_frame_shift();
+extern float jw_localize_pass();    // return delay to next call
 #endif